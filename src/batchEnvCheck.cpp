@@ -0,0 +1,163 @@
+// Sanity check of the batch environment: steps headless games and verifies the record layout,
+// that down hard drops and that finished games start over on an empty board
+// Build: g++ -std=c++17 src/batchEnvCheck.cpp -o batchEnvCheck -lSDL2 -lSDL2_ttf -lSDL2_image
+// Usage: batchEnvCheck [games] [steps]
+
+#include <SDL2/SDL.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "./class/batchEnv.hpp"
+
+#define CHECK_GAMES 64
+#define CHECK_STEPS 2000
+
+static_assert(BATCH_RECORD_SIZE == OBSERVATION_SIZE + 2, "a record is the observation, the reward and the done flag");
+static_assert(BATCH_REWARD_OFFSET == OBSERVATION_SIZE && BATCH_DONE_OFFSET == OBSERVATION_SIZE + 1, "reward and done follow the observation");
+
+int countPlacedCells(const float *record);
+bool checkRecord(const float *record, int game);
+
+int main(int argc, char **argv)
+{
+    int gamesCount = argc > 1 ? atoi(argv[1]) : CHECK_GAMES;
+    int stepsCount = argc > 2 ? atoi(argv[2]) : CHECK_STEPS;
+
+    if (gamesCount < 1 || stepsCount < 1)
+    {
+        std::cerr << "Usage: " << argv[0] << " [games] [steps]" << std::endl;
+        return 1;
+    }
+
+    BatchEnv env(gamesCount, 1);
+
+    std::vector<float> records(static_cast<size_t>(gamesCount) * BATCH_RECORD_SIZE);
+    std::vector<arrows> actions(gamesCount);
+
+    env.reset(records.data());
+
+    for (int game = 0; game < gamesCount; game++)
+    {
+        const float *record = &records[static_cast<size_t>(game) * BATCH_RECORD_SIZE];
+
+        if (!checkRecord(record, game) || countPlacedCells(record) != 0 || record[BATCH_REWARD_OFFSET] != 0 || record[BATCH_DONE_OFFSET] != 0)
+        {
+            std::cerr << "Game " << game << " does not start on an empty board with no reward" << std::endl;
+            return 1;
+        }
+    }
+
+    std::minstd_rand randomEngine(1);
+    std::vector<int> placedBefore(gamesCount, 0);
+
+    int drops = 0;
+    int resets = 0;
+
+    for (int step = 0; step < stepsCount; step++)
+    {
+        for (auto &action : actions)
+        {
+            action = static_cast<arrows>(randomEngine() % (ARROW_LEFT + 1));
+        }
+
+        env.step(actions.data(), records.data());
+
+        for (int game = 0; game < gamesCount; game++)
+        {
+            const float *record = &records[static_cast<size_t>(game) * BATCH_RECORD_SIZE];
+
+            if (!checkRecord(record, game))
+            {
+                return 1;
+            }
+
+            int placed = countPlacedCells(record);
+            bool done = record[BATCH_DONE_OFFSET] == 1;
+
+            if (done)
+            {
+                resets++;
+
+                // The record already holds the new game
+                if (placed != 0)
+                {
+                    std::cerr << "Game " << game << " was not reset after it ended" << std::endl;
+                    return 1;
+                }
+            }
+            else if (actions[game] == ARROW_DOWN && record[BATCH_REWARD_OFFSET] == 0)
+            {
+                drops++;
+
+                // Without a cleared row a hard drop leaves the whole block on the board
+                if (placed != placedBefore[game] + CELLS_IN_BLOCK)
+                {
+                    std::cerr << "Game " << game << " did not lock its block on down, " << placedBefore[game] << " cells before and " << placed << " after" << std::endl;
+                    return 1;
+                }
+            }
+
+            placedBefore[game] = placed;
+        }
+    }
+
+    if (resets == 0)
+    {
+        std::cerr << "No game ended in " << stepsCount << " steps, the reset was not checked" << std::endl;
+        return 1;
+    }
+
+    std::cout << "BatchEnv ok: " << gamesCount << " games, " << stepsCount << " steps, " << drops << " hard drops, " << resets << " resets" << std::endl;
+    return 0;
+}
+
+int countPlacedCells(const float *record)
+{
+    int placed = 0;
+    for (int i = 0; i < OBSERVATION_PLANE_SIZE; i++)
+    {
+        placed += record[i] == 1;
+    }
+    return placed;
+}
+
+// Planes hold only zeros and ones, the block types are one-hot and done is a flag
+bool checkRecord(const float *record, int game)
+{
+    for (int i = 0; i < 2 * OBSERVATION_PLANE_SIZE; i++)
+    {
+        if (record[i] != 0 && record[i] != 1)
+        {
+            std::cerr << "Game " << game << " has " << record[i] << " in its planes at " << i << std::endl;
+            return false;
+        }
+    }
+
+    for (int oneHot = 0; oneHot < 2; oneHot++)
+    {
+        const float *blockType = record + 2 * OBSERVATION_PLANE_SIZE + oneHot * BLOCK_TYPES_TOTAL;
+
+        float sum = 0;
+        for (int type = 0; type < BLOCK_TYPES_TOTAL; type++)
+        {
+            sum += blockType[type];
+        }
+
+        if (sum != 1)
+        {
+            std::cerr << "Game " << game << " has no one-hot block type" << std::endl;
+            return false;
+        }
+    }
+
+    float done = record[BATCH_DONE_OFFSET];
+    if ((done != 0 && done != 1) || record[BATCH_REWARD_OFFSET] < 0)
+    {
+        std::cerr << "Game " << game << " has reward " << record[BATCH_REWARD_OFFSET] << " and done " << done << std::endl;
+        return false;
+    }
+    return true;
+}
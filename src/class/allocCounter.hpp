@@ -0,0 +1,148 @@
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <iostream>
+#include <cstdlib>
+#include <new>
+
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+// Debug build mode (compile with -DALLOC_COUNT) counting every heap allocation
+// so the main loop can assert that a warmed up frame does not allocate. Besides
+// operator new this counts everything SDL and SDL_ttf allocate with SDL_malloc.
+
+// Frames allowed to allocate while textures, fonts and buffers settle
+#define ALLOC_WARMUP_FRAMES 120
+
+#ifdef ALLOC_COUNT
+
+std::atomic<Uint64> allocationsCount(0);
+
+void *operator new(std::size_t size)
+{
+    allocationsCount.fetch_add(1, std::memory_order_relaxed);
+
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// SDL's own allocator, the counting wrappers forward to it
+SDL_malloc_func sdlMalloc = nullptr;
+SDL_calloc_func sdlCalloc = nullptr;
+SDL_realloc_func sdlRealloc = nullptr;
+SDL_free_func sdlFree = nullptr;
+
+void *countingSdlMalloc(size_t size)
+{
+    allocationsCount.fetch_add(1, std::memory_order_relaxed);
+    return sdlMalloc(size);
+}
+void *countingSdlCalloc(size_t count, size_t size)
+{
+    allocationsCount.fetch_add(1, std::memory_order_relaxed);
+    return sdlCalloc(count, size);
+}
+void *countingSdlRealloc(void *memory, size_t size)
+{
+    allocationsCount.fetch_add(1, std::memory_order_relaxed);
+    return sdlRealloc(memory, size);
+}
+void countingSdlFree(void *memory)
+{
+    sdlFree(memory);
+}
+
+// Has to run before SDL_Init, memory SDL allocated earlier would be freed by the wrong functions
+void countSdlAllocations()
+{
+    SDL_GetMemoryFunctions(&sdlMalloc, &sdlCalloc, &sdlRealloc, &sdlFree);
+
+    if (SDL_SetMemoryFunctions(countingSdlMalloc, countingSdlCalloc, countingSdlRealloc, countingSdlFree) < 0)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+    }
+}
+
+class AllocFrameCounter
+{
+private:
+    Uint64 frame = 0;
+    Uint64 frameStartCount = 0;
+
+    // Runs on the thread pumping events, the same one that counts the frames
+    static int watchLayout(void *counter, SDL_Event *event);
+
+public:
+    AllocFrameCounter();
+    ~AllocFrameCounter();
+
+    void beginFrame();
+
+    // Returns false when a frame past the warm-up allocated
+    bool endFrame();
+};
+AllocFrameCounter::AllocFrameCounter()
+{
+    SDL_AddEventWatch(watchLayout, this);
+}
+AllocFrameCounter::~AllocFrameCounter()
+{
+    SDL_DelEventWatch(watchLayout, this);
+}
+// A resize, a DPI change or a render reset rebuilds the cell atlas and the HUD glyphs, so the warm-up starts over
+int AllocFrameCounter::watchLayout(void *counter, SDL_Event *event)
+{
+    bool windowChanged = event->type == SDL_WINDOWEVENT && (event->window.event == SDL_WINDOWEVENT_RESIZED || event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                                                              event->window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED);
+    bool renderReset = event->type == SDL_RENDER_TARGETS_RESET || event->type == SDL_RENDER_DEVICE_RESET;
+
+    if (windowChanged || renderReset)
+    {
+        static_cast<AllocFrameCounter *>(counter)->frame = 0;
+    }
+    return 0;
+}
+void AllocFrameCounter::beginFrame()
+{
+    frameStartCount = allocationsCount.load(std::memory_order_relaxed);
+}
+bool AllocFrameCounter::endFrame()
+{
+    Uint64 frameAllocations = allocationsCount.load(std::memory_order_relaxed) - frameStartCount;
+
+    frame++;
+    if (frame > ALLOC_WARMUP_FRAMES && frameAllocations != 0)
+    {
+        std::cerr << "Frame " << frame << " made " << frameAllocations << " heap allocations" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif
+#endif
@@ -0,0 +1,228 @@
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "./game.hpp"
+
+#ifndef BATCH_ENV_HPP
+#define BATCH_ENV_HPP
+
+// In milisecounds, game time that passes on every step
+#define BATCH_STEP_TIME 50
+
+// Floats written for every game, its observation followed by the step's reward and done flag
+#define BATCH_RECORD_SIZE (OBSERVATION_SIZE + 2)
+#define BATCH_REWARD_OFFSET OBSERVATION_SIZE
+#define BATCH_DONE_OFFSET (OBSERVATION_SIZE + 1)
+
+class BatchEnv;
+
+typedef struct batchWorker
+{
+    BatchEnv *env;
+    int firstGame;
+    int lastGame;
+    SDL_sem *startSemaphore;
+    // nullptr when the thread could not be started, step() then runs these games itself
+    SDL_Thread *thread;
+} batchWorker;
+
+// Steps many headless games in lockstep for training, split between a pool of worker threads.
+// Observations go straight into the caller's buffer, BATCH_RECORD_SIZE floats per game, and
+// finished games start over on their own, their record then holds the new game with done set.
+class BatchEnv
+{
+private:
+    // Games keep references into themselves, the deque never moves them
+    std::deque<Game> games;
+    Uint64 stepTime;
+
+    std::vector<batchWorker> workers;
+    SDL_sem *doneSemaphore = nullptr;
+    std::atomic<bool> running;
+
+    // Set before the workers start every step
+    const arrows *actions = nullptr;
+    float *records = nullptr;
+
+    static int work(void *worker);
+
+    void stepGames(int firstGame, int lastGame);
+
+public:
+    // %threadsCount% of 0 uses one worker per CPU core
+    BatchEnv(int gamesCount, unsigned seed, Uint64 loadStepTime = BATCH_STEP_TIME, int threadsCount = 0);
+    ~BatchEnv();
+
+    int getGamesCount();
+
+    // Starts every game over and writes their records, with no reward and done cleared
+    void reset(float *loadRecords);
+    // Applies %loadActions[i]% to game i: left and right move, up rotates, down hard drops
+    // and locks the block. Blocks until every game has been stepped.
+    void step(const arrows *loadActions, float *loadRecords);
+};
+BatchEnv::BatchEnv(int gamesCount, unsigned seed, Uint64 loadStepTime, int threadsCount)
+    : stepTime(loadStepTime),
+      running(true)
+{
+    for (int i = 0; i < gamesCount; i++)
+    {
+        games.emplace_back(nullptr, nullptr, nullptr, seed + i);
+    }
+
+    if (threadsCount <= 0)
+    {
+        threadsCount = SDL_GetCPUCount();
+    }
+    threadsCount = std::max(1, std::min(threadsCount, gamesCount));
+
+    doneSemaphore = SDL_CreateSemaphore(0);
+    if (doneSemaphore == nullptr)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+    }
+
+    workers.resize(threadsCount);
+
+    // Every worker owns a contiguous range of games for its whole life
+    for (int i = 0; i < threadsCount; i++)
+    {
+        batchWorker &worker = workers[i];
+
+        worker.env = this;
+        worker.firstGame = gamesCount * i / threadsCount;
+        worker.lastGame = gamesCount * (i + 1) / threadsCount;
+        worker.startSemaphore = nullptr;
+        worker.thread = nullptr;
+
+        if (doneSemaphore == nullptr)
+        {
+            continue;
+        }
+
+        worker.startSemaphore = SDL_CreateSemaphore(0);
+        if (worker.startSemaphore != nullptr)
+        {
+            worker.thread = SDL_CreateThread(work, "BatchEnv", &worker);
+        }
+
+        if (worker.thread == nullptr)
+        {
+            std::cerr << SDL_GetError() << std::endl;
+
+            SDL_DestroySemaphore(worker.startSemaphore);
+            worker.startSemaphore = nullptr;
+        }
+    }
+}
+BatchEnv::~BatchEnv()
+{
+    running = false;
+
+    for (auto &worker : workers)
+    {
+        if (worker.thread == nullptr)
+        {
+            continue;
+        }
+
+        SDL_SemPost(worker.startSemaphore);
+        SDL_WaitThread(worker.thread, nullptr);
+        SDL_DestroySemaphore(worker.startSemaphore);
+    }
+
+    SDL_DestroySemaphore(doneSemaphore);
+}
+int BatchEnv::work(void *worker)
+{
+    batchWorker *self = static_cast<batchWorker *>(worker);
+    BatchEnv *env = self->env;
+
+    while (true)
+    {
+        SDL_SemWait(self->startSemaphore);
+
+        if (!env->running)
+        {
+            break;
+        }
+
+        env->stepGames(self->firstGame, self->lastGame);
+
+        SDL_SemPost(env->doneSemaphore);
+    }
+    return 0;
+}
+void BatchEnv::stepGames(int firstGame, int lastGame)
+{
+    for (int i = firstGame; i < lastGame; i++)
+    {
+        Game &game = games[i];
+        float *record = records + static_cast<size_t>(i) * BATCH_RECORD_SIZE;
+
+        int pointsBefore = game.getPoints();
+        // A single soft drop row is rarely worth a step, down drops all the way like a double tap
+        game.step(actions[i], stepTime, actions[i] == ARROW_DOWN);
+
+        record[BATCH_REWARD_OFFSET] = game.getPoints() - pointsBefore;
+        record[BATCH_DONE_OFFSET] = game.exit;
+
+        if (game.exit)
+        {
+            game.reset();
+        }
+
+        game.writeObservation(record);
+    }
+}
+int BatchEnv::getGamesCount()
+{
+    return games.size();
+}
+void BatchEnv::reset(float *loadRecords)
+{
+    for (int i = 0; i < getGamesCount(); i++)
+    {
+        float *record = loadRecords + static_cast<size_t>(i) * BATCH_RECORD_SIZE;
+
+        games[i].reset();
+        games[i].writeObservation(record);
+
+        record[BATCH_REWARD_OFFSET] = 0;
+        record[BATCH_DONE_OFFSET] = 0;
+    }
+}
+void BatchEnv::step(const arrows *loadActions, float *loadRecords)
+{
+    actions = loadActions;
+    records = loadRecords;
+
+    int startedWorkers = 0;
+    for (auto &worker : workers)
+    {
+        if (worker.thread != nullptr)
+        {
+            SDL_SemPost(worker.startSemaphore);
+            startedWorkers++;
+        }
+    }
+
+    // Only the workers that are running post doneSemaphore, the others are stepped right here
+    for (auto &worker : workers)
+    {
+        if (worker.thread == nullptr)
+        {
+            stepGames(worker.firstGame, worker.lastGame);
+        }
+    }
+
+    for (int i = 0; i < startedWorkers; i++)
+    {
+        SDL_SemWait(doneSemaphore);
+    }
+}
+#endif
@@ -1,6 +1,12 @@
 #include <SDL2/SDL.h>
 #include <array>
 #include <cmath>
+#include <random>
+
+#include "./placedCells.hpp"
+
+#ifndef BLOCK_HPP
+#define BLOCK_HPP
 
 #ifndef ROWS_QUANTITY
 #define ROWS_QUANTITY 20
@@ -19,50 +25,48 @@ enum blockTypesNames
     BLOCK_TYPES_TOTAL
 };
 
-#ifndef CELL_STRUCT
-#define CELL_STRUCT
-typedef struct cell
-{
-    SDL_Point pos;
-    SDL_Color color;
-} cell;
-#endif
-
 class TBlock
 {
 private:
     int width;
     int length;
 
+    // Lowest cell of the block in each of its columns
+    std::array<int, 4> bottomProfile;
+
     void calcBlockWidth();
     void calcBlockLength();
+    void calcBottomProfile();
     void resetPos();
 
-    std::vector<cell> &placedCells;  // Fixed error: Reference to the placedCells vector
+    PlacedCells &placedCells;
+    std::minstd_rand &randomEngine;
 
 public:
     blockTypesNames type;
 
-    // Constructor: Initialize the reference to placedCells using an initializer list
-    TBlock(std::vector<cell> &placedCells) : placedCells(placedCells) {}
+    // Constructor: Initialize the references to the board and the game's random engine using an initializer list
+    TBlock(PlacedCells &placedCells, std::minstd_rand &randomEngine) : placedCells(placedCells), randomEngine(randomEngine) {}
 
     SDL_Point pos;
-    SDL_Color color;
 
     std::array<SDL_Point, 4> cells;
 
-    void rotate();
+    // Returns false when the rotated block would not fit and it kept its cells
+    bool rotate();
     void reset();
 
     int getWidth();
     int getLength();
+    int getBottom(int column);
 
     bool checkColisionRight(std::array<SDL_Point, 4> *block = nullptr);
     bool checkColisionLeft(std::array<SDL_Point, 4> *block = nullptr);
-    bool isPlaced();
+    // Whether %block% at the current position leaves the board or covers the floor or a placed cell
+    bool checkOverlap(std::array<SDL_Point, 4> *block = nullptr);
 };
 
-void TBlock::rotate()
+bool TBlock::rotate()
 {
     std::swap(this->width, this->length);
 
@@ -72,16 +76,23 @@ void TBlock::rotate()
     {
         int blockCellYold = blockCell.x;
         blockCell.x = blockCell.y;
-        blockCell.y = this->width - 1 - blockCellYold;
+        blockCell.y = this->length - 1 - blockCellYold;
     }
 
-    if (!checkColisionRight(nullptr) && !checkColisionLeft(nullptr))
+    // Only the rotated cells matter, a block touching a wall may still turn away from it
+    bool insideBoard = pos.x + this->width <= COLUMNS_QUANTITY;
+
+    bool rotated = insideBoard && !checkOverlap(&rotateCopy);
+    if (rotated)
     {
         cells = rotateCopy;
     }
 
     calcBlockLength();
     calcBlockWidth();
+    calcBottomProfile();
+
+    return rotated;
 }
 
 void TBlock::calcBlockLength()
@@ -104,10 +115,20 @@ void TBlock::calcBlockWidth()
     width = maxTilt + 1;
 }
 
+void TBlock::calcBottomProfile()
+{
+    bottomProfile.fill(-1);
+    for (auto cell : cells)
+    {
+        bottomProfile[cell.x] = std::max(bottomProfile[cell.x], cell.y);
+    }
+}
+
 void TBlock::reset()
 {
     calcBlockWidth();
     calcBlockLength();
+    calcBottomProfile();
 
     resetPos();
 }
@@ -115,7 +136,7 @@ void TBlock::reset()
 void TBlock::resetPos()
 {
     pos.y = -(this->length);
-    pos.x = rand() % (COLUMNS_QUANTITY - this->width);
+    pos.x = randomEngine() % (COLUMNS_QUANTITY - this->width);
 }
 
 int TBlock::getWidth()
@@ -128,6 +149,11 @@ int TBlock::getLength()
     return length;
 }
 
+int TBlock::getBottom(int column)
+{
+    return bottomProfile[column];
+}
+
 bool TBlock::checkColisionLeft(std::array<SDL_Point, 4> *block /*= nullptr*/)
 {
     std::array<SDL_Point, 4> cellsToCheck = (block == nullptr) ? cells : *block;
@@ -137,39 +163,30 @@ bool TBlock::checkColisionLeft(std::array<SDL_Point, 4> *block /*= nullptr*/)
         return true;
     }
 
-    for (auto placedCell : placedCells)
+    for (auto blockCell : cellsToCheck)
     {
-        for (auto blockCell : cellsToCheck)
+        if (placedCells.isOccupied(blockCell.x + pos.x - 1, blockCell.y + pos.y))
         {
-            bool cellsSameLevel = blockCell.y + pos.y == placedCell.pos.y;
-            bool cellsSticking = blockCell.x + pos.x - 1 == placedCell.pos.x;
-
-            if (cellsSameLevel && cellsSticking)
-            {
-                return true;
-            }
+            return true;
         }
     }
     return false;
 }
 
-bool TBlock::isPlaced()
+bool TBlock::checkOverlap(std::array<SDL_Point, 4> *block /*= nullptr*/)
 {
-    for (auto currentBlockCell : cells)
+    std::array<SDL_Point, 4> cellsToCheck = (block == nullptr) ? cells : *block;
+
+    for (auto blockCell : cellsToCheck)
     {
-        int currentBlockCellY = pos.y + currentBlockCell.y + 1;
+        int column = blockCell.x + pos.x;
+        int row = blockCell.y + pos.y;
 
-        if (currentBlockCellY == ROWS_QUANTITY)
+        // The floor counts as occupied
+        if (column < 0 || column >= COLUMNS_QUANTITY || placedCells.isOccupied(column, row))
         {
             return true;
         }
-        for (auto placedCell : placedCells)
-        {
-            if (pos.x + currentBlockCell.x == placedCell.pos.x && currentBlockCellY == placedCell.pos.y)
-            {
-                return true;
-            }
-        }
     }
     return false;
 }
@@ -182,18 +199,13 @@ bool TBlock::checkColisionRight(std::array<SDL_Point, 4> *block /*= nullptr*/)
     {
         return true;
     }
-    for (auto placedCell : placedCells)
+    for (auto blockCell : cellsToCheck)
     {
-        for (auto blockCell : cells)
+        if (placedCells.isOccupied(blockCell.x + pos.x + 1, blockCell.y + pos.y))
         {
-            bool cellsSameLevel = blockCell.y + pos.y == placedCell.pos.y;
-            bool cellsSticking = blockCell.x + pos.x + 1 == placedCell.pos.x;
-
-            if (cellsSameLevel && cellsSticking)
-            {
-                return true;
-            }
+            return true;
         }
     }
     return false;
 }
+#endif
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include <SDL2/SDL.h>
+
+#include <array>
+#include <algorithm>
+
+#include "./block.hpp"
+#include "./texture.hpp"
+
+#ifndef CELL_ATLAS_HPP
+#define CELL_ATLAS_HPP
+
+#define CELL_ATLAS_PATH "./bin/textures/cells.png"
+
+// Tiles of the atlas, laid out left to right in one row. The first BLOCK_TYPES_TOTAL
+// tiles are the skins of the block types, in the order of blockTypesNames.
+enum cellTiles
+{
+    CELL_TILE_GHOST = BLOCK_TYPES_TOTAL,
+    CELL_TILE_GARBAGE,
+    CELL_TILES_TOTAL
+};
+
+// Cell skins loaded from one PNG. On every resize the tiles are scaled once into a
+// second texture at exactly the size they are drawn, so frames only copy pixels 1:1.
+class CellAtlas
+{
+private:
+    SDL_Renderer *gRenderer;
+
+    GTexture sourceTexture;
+    GTexture scaledTexture;
+
+    // Texture coordinates of every tile at the board and at the preview cell size
+    std::array<SDL_FRect, CELL_TILES_TOTAL> boardTiles;
+    std::array<SDL_FRect, CELL_TILES_TOTAL> previewTiles;
+
+    // Sizes the scaled texture was made for, a resize keeping them reuses it
+    int scaledCellW = 0, scaledCellH = 0, scaledPreviewSize = 0;
+
+    void calcSourceTiles();
+
+public:
+    CellAtlas(SDL_Renderer *loadRenderer);
+
+    void load(const char *path);
+    void rescale(int boardCellW, int boardCellH, int previewCellSize);
+
+    // nullptr when the atlas could not be loaded, cells are then plain colored quads
+    SDL_Texture *getTexture();
+    SDL_FRect getTile(int tile, bool preview);
+};
+CellAtlas::CellAtlas(SDL_Renderer *loadRenderer)
+    : gRenderer(loadRenderer),
+      sourceTexture(loadRenderer),
+      scaledTexture(loadRenderer)
+{
+}
+// Also used after a render reset, the next rescale then draws the scaled tiles again
+void CellAtlas::load(const char *path)
+{
+    scaledTexture.free();
+    sourceTexture.loadImgTexture(path);
+
+    calcSourceTiles();
+}
+// Until the atlas is rescaled, or when the renderer can't draw into textures, tiles come from the source
+void CellAtlas::calcSourceTiles()
+{
+    for (int tile = 0; tile < CELL_TILES_TOTAL; tile++)
+    {
+        boardTiles[tile] = {static_cast<float>(tile) / CELL_TILES_TOTAL, 0, 1.0F / CELL_TILES_TOTAL, 1};
+        previewTiles[tile] = boardTiles[tile];
+    }
+}
+void CellAtlas::rescale(int boardCellW, int boardCellH, int previewCellSize)
+{
+    if (sourceTexture.getTexture() == nullptr)
+    {
+        return;
+    }
+
+    if (scaledTexture.getTexture() != nullptr && boardCellW == scaledCellW && boardCellH == scaledCellH && previewCellSize == scaledPreviewSize)
+    {
+        return;
+    }
+
+    // Board tiles on the first row, preview tiles on the second
+    int tileW = std::max(boardCellW, previewCellSize);
+    int scaledW = tileW * CELL_TILES_TOTAL;
+    int scaledH = boardCellH + previewCellSize;
+
+    if (!scaledTexture.loadTargetTexture(scaledW, scaledH))
+    {
+        calcSourceTiles();
+        return;
+    }
+
+    scaledCellW = boardCellW;
+    scaledCellH = boardCellH;
+    scaledPreviewSize = previewCellSize;
+
+    SDL_Texture *windowTarget = SDL_GetRenderTarget(gRenderer);
+    SDL_SetRenderTarget(gRenderer, scaledTexture.getTexture());
+
+    SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, SDL_ALPHA_TRANSPARENT);
+    SDL_RenderClear(gRenderer);
+
+    // Copy the alpha as it is instead of blending the tiles onto the cleared texture
+    SDL_SetTextureBlendMode(sourceTexture.getTexture(), SDL_BLENDMODE_NONE);
+
+    int sourceTileW = sourceTexture.getWidth() / CELL_TILES_TOTAL;
+
+    for (int tile = 0; tile < CELL_TILES_TOTAL; tile++)
+    {
+        SDL_Rect sourceRect = {tile * sourceTileW, 0, sourceTileW, sourceTexture.getHeight()};
+        SDL_Rect boardRect = {tile * tileW, 0, boardCellW, boardCellH};
+        SDL_Rect previewRect = {tile * tileW, boardCellH, previewCellSize, previewCellSize};
+
+        SDL_RenderCopy(gRenderer, sourceTexture.getTexture(), &sourceRect, &boardRect);
+        SDL_RenderCopy(gRenderer, sourceTexture.getTexture(), &sourceRect, &previewRect);
+
+        boardTiles[tile] = {static_cast<float>(boardRect.x) / scaledW, 0, static_cast<float>(boardCellW) / scaledW, static_cast<float>(boardCellH) / scaledH};
+        previewTiles[tile] = {static_cast<float>(previewRect.x) / scaledW, static_cast<float>(boardCellH) / scaledH, static_cast<float>(previewCellSize) / scaledW, static_cast<float>(previewCellSize) / scaledH};
+    }
+
+    SDL_SetTextureBlendMode(sourceTexture.getTexture(), SDL_BLENDMODE_BLEND);
+    SDL_SetTextureBlendMode(scaledTexture.getTexture(), SDL_BLENDMODE_BLEND);
+
+    SDL_SetRenderTarget(gRenderer, windowTarget);
+}
+SDL_Texture *CellAtlas::getTexture()
+{
+    return scaledTexture.getTexture() != nullptr ? scaledTexture.getTexture() : sourceTexture.getTexture();
+}
+SDL_FRect CellAtlas::getTile(int tile, bool preview)
+{
+    return preview ? previewTiles[tile] : boardTiles[tile];
+}
+#endif
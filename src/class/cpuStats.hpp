@@ -0,0 +1,107 @@
+#include <SDL2/SDL.h>
+
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifndef CPU_STATS_HPP
+#define CPU_STATS_HPP
+
+// In milisecounds
+#define CPU_STATS_PERIOD 60000
+
+// Prints the process CPU time spent per minute of wall time and how many frames were redrawn
+class CpuStats
+{
+private:
+    Uint64 periodStart;
+    // In milisecounds
+    double periodCpuStart;
+
+    Uint64 frames = 0;
+    Uint64 redraws = 0;
+
+    // User and kernel time of the whole process in milisecounds, std::clock() is wall time on MinGW
+    static double getProcessCpuTime();
+
+public:
+    CpuStats();
+
+    void frame(bool redrawn);
+    void report();
+};
+CpuStats::CpuStats()
+{
+    periodStart = SDL_GetTicks64();
+    periodCpuStart = getProcessCpuTime();
+}
+void CpuStats::frame(bool redrawn)
+{
+    frames++;
+    if (redrawn)
+    {
+        redraws++;
+    }
+
+    if (SDL_GetTicks64() - periodStart >= CPU_STATS_PERIOD)
+    {
+        report();
+    }
+}
+void CpuStats::report()
+{
+    Uint64 wallTime = SDL_GetTicks64() - periodStart;
+    double cpuTime = getProcessCpuTime() - periodCpuStart;
+
+    if (wallTime == 0)
+    {
+        return;
+    }
+
+    double cpuPerMinute = cpuTime * 60000.0 / wallTime;
+
+    std::cout << "CPU time: " << cpuPerMinute << " ms per minute, "
+              << frames << " frames, " << redraws << " redraws in " << wallTime << " ms" << std::endl;
+
+    periodStart = SDL_GetTicks64();
+    periodCpuStart = getProcessCpuTime();
+    frames = 0;
+    redraws = 0;
+}
+double CpuStats::getProcessCpuTime()
+{
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        return 0;
+    }
+
+    // FILETIME counts 100 ns intervals
+    ULARGE_INTEGER kernel = {{kernelTime.dwLowDateTime, kernelTime.dwHighDateTime}};
+    ULARGE_INTEGER user = {{userTime.dwLowDateTime, userTime.dwHighDateTime}};
+
+    return (kernel.QuadPart + user.QuadPart) / 10000.0;
+#else
+    rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+#endif
+}
+#endif
@@ -3,11 +3,17 @@
 #include <array>
 #include <vector>
 #include <cmath>
-#include <map>
+#include <random>
 
-#include "./texture.hpp"
 #include "./block.hpp"
 #include "./placedCells.hpp"
+#include "./tripleBuffer.hpp"
+#include "./renderSnapshot.hpp"
+#include "./telemetry.hpp"
+#include "./soundMixer.hpp"
+
+#ifndef GAME_HPP
+#define GAME_HPP
 
 #define CELLS_IN_BLOCK 4
 
@@ -16,14 +22,24 @@
 
 #define DOUBLE_CLICK_DELAY 500
 
-#ifndef CELL_STRUCT
-#define CELL_STRUCT
-typedef struct block
-{
-    SDL_Color color;
-    std::array<SDL_Point, CELLS_IN_BLOCK> cells;
-} block;
-#endif
+// In milisecounds, how long a level 1 block takes to fall one row
+#define AUTO_FALL_FREQUENCY 750
+
+#define LINES_PER_LEVEL 10
+#define MAX_LEVEL 20
+
+// Rows per milisecound at 20G, 20 rows every 60 Hz frame, the block lands instantly
+#define GRAVITY_20G (20.0F * 60 / 1000)
+
+// In milisecounds, how long a block can rest on the stack before it locks
+#define LOCK_DELAY 500
+// How many times moving or rotating a resting block restarts its lock delay
+#define LOCK_RESETS_MAX 15
+
+// Floats written by Game::writeObservation, an occupancy plane of the placed cells,
+// one of the current block and one-hots of the current and next block types
+#define OBSERVATION_PLANE_SIZE (ROWS_QUANTITY * COLUMNS_QUANTITY)
+#define OBSERVATION_SIZE (2 * OBSERVATION_PLANE_SIZE + 2 * BLOCK_TYPES_TOTAL)
 
 enum arrows
 {
@@ -37,134 +53,236 @@ enum arrows
 class Game
 {
 private:
-    SDL_Window *gWindow;
-    SDL_Renderer *gRenderer;
+    TripleBuffer<renderSnapshot> *snapshots;
 
-    TTF_Font *gFont;
+    Telemetry *telemetry;
+    SoundMixer *mixer;
 
     SDL_Event e;
 
-    int cellW, cellH;
+    // Render target and device resets seen so far, the renderer rebuilds its textures when this changes
+    Uint32 renderResets = 0;
 
-    std::vector<cell> pCells;
+    // Every game draws its blocks from its own engine, so games can run side by side on many threads
+    std::minstd_rand randomEngine;
 
     Uint64 startTime;
-    Uint64 currentFrameTime;
-    GTexture currentFrameTimeTexture;
+    Uint64 currentFrameTime = 0;
+    int clockDecimals = 2;
+    // Clock value, in steps of its resolution, shown by the last published snapshot
+    Uint64 publishedClock = 0;
 
     int points = 0;
-    GTexture pointsTexture;
+    int linesCleared = 0;
+    int level = 1;
 
-    TBlock currentBlock;
-    blockTypesNames nextBlock;
+    // Fraction of a row the current block has fallen but not moved yet
+    float gravityRows = 0;
+    float rowsPerMs;
+
+    bool blockResting = false;
+    Uint64 lockDelayStart = 0;
+    int lockResets = 0;
+
+    filledRows rowsToClear;
 
     PlacedCells placedCells;
 
-    SDL_Rect gameViewPort;
-    SDL_Rect generalViewPort;
+    TBlock currentBlock;
+    blockTypesNames nextBlock;
 
     arrows keyPressed = ARROW_NONE;
+    bool hardDrop = false;
 
-    std::string getCurrentTimeStr();
+    bool redrawNeeded = true;
 
-    void handleGameResize();
+    Uint64 getClockResolution();
 
-    void drawCurrentBlock();
-    void drawPlacedCells();
-    void drawNextBlock();
-    void drawCell(SDL_Point cords, SDL_Color color);
+    void publishSnapshot();
 
-    SDL_Color getBlockTypeColor(blockTypesNames blockType);
     std::array<SDL_Point, CELLS_IN_BLOCK> getBlockTypeCells(blockTypesNames blockType);
 
+    const char *getArrowName(arrows arrow);
+    void playSound(soundEffects effect);
+
+    blockTypesNames getRandomBlockType();
+
+    int getDropDistance();
+    void lockCurrentBlock();
+
+    void calcGravity();
+
+    void advance(Uint64 gameTime);
+
     int calcPoints(int rowsCleared);
     void addPoints(int points);
 
 public:
-    Game(SDL_Window *loadWindow, SDL_Renderer *loadRenderer, TTF_Font *loadFont);
+    // %loadTelemetry% and %loadMixer% can be nullptr when no metrics are recorded or no sound is played,
+    // a headless game (no snapshots) is only driven by step()
+    Game(TripleBuffer<renderSnapshot> *loadSnapshots, Telemetry *loadTelemetry, SoundMixer *loadMixer, unsigned seed);
 
     bool exit = false;
 
+    // Starts a new game on an empty board
+    void reset();
+
     void handleEvents();
+    // For events pumped by someone else, e.g. on another thread, they count for the next update
+    void handleEvent(const SDL_Event &event);
+    // Publishes a new snapshot whenever something on screen changed
     void update();
-    void render();
+
+    // Power saving: clock shown in tenths of a second, so waitEvents wakes less often
+    void enableIdleMode();
+    // Sleeps until input or the next deadline, a fall, a lock or a change of the shown clock
+    void waitEvents();
+    // Milisecounds until that deadline
+    int getIdleTimeout();
+
+    // Headless stepping: applies %action% like a key press, with %drop% like a hard drop,
+    // then advances the game by %stepTime% milisecounds
+    void step(arrows action, Uint64 stepTime, bool drop = false);
+    int getPoints();
+
+    // Colors live here only, the board keeps block types and the renderer resolves them when drawing
+    static SDL_Color getBlockTypeColor(blockTypesNames blockType);
+    // Fills OBSERVATION_SIZE floats at %observation%
+    void writeObservation(float *observation);
 };
-Game::Game(SDL_Window *loadWindow, SDL_Renderer *loadRenderer, TTF_Font *loadFont)
-    : gWindow(loadWindow),
-      gRenderer(loadRenderer),
-      gFont(loadFont),
-      pCells(),
-      placedCells(pCells),
-      currentBlock(pCells),
-      currentFrameTimeTexture(gRenderer),
-      pointsTexture(gRenderer)
+Game::Game(TripleBuffer<renderSnapshot> *loadSnapshots, Telemetry *loadTelemetry, SoundMixer *loadMixer, unsigned seed)
+    : snapshots(loadSnapshots),
+      telemetry(loadTelemetry),
+      mixer(loadMixer),
+      randomEngine(seed),
+      placedCells(),
+      currentBlock(placedCells, randomEngine)
+{
+    if (telemetry != nullptr)
+    {
+        telemetry->recordStart(seed);
+    }
+
+    reset();
+}
+void Game::reset()
 {
+    placedCells.clear();
+
+    points = 0;
+    linesCleared = 0;
+    level = 1;
 
-    handleGameResize();
-    SDL_RenderGetViewport(gRenderer, &generalViewPort);
+    gravityRows = 0;
+    blockResting = false;
+    lockResets = 0;
 
-    currentBlock.type = static_cast<blockTypesNames>(rand() % BLOCK_TYPES_TOTAL);
+    currentBlock.type = getRandomBlockType();
     currentBlock.cells = getBlockTypeCells(currentBlock.type);
-    currentBlock.color = getBlockTypeColor(currentBlock.type);
 
-    nextBlock = static_cast<blockTypesNames>(rand() % BLOCK_TYPES_TOTAL);
+    nextBlock = getRandomBlockType();
 
     currentBlock.reset();
 
-    addPoints(0);
+    calcGravity();
+
+    exit = false;
+
     startTime = SDL_GetTicks64();
+    currentFrameTime = 0;
+    publishedClock = 0;
+
+    if (snapshots != nullptr)
+    {
+        publishSnapshot();
+    }
 }
 
 void Game::handleEvents()
 {
-    static Uint64 lastArrowDownClick = 0;
+    while (SDL_PollEvent(&e))
+    {
+        handleEvent(e);
+    }
+}
+void Game::waitEvents()
+{
+    if (SDL_WaitEventTimeout(&e, getIdleTimeout()))
+    {
+        handleEvent(e);
 
-    keyPressed = ARROW_NONE;
+        while (SDL_PollEvent(&e))
+        {
+            handleEvent(e);
+        }
+    }
+}
+void Game::handleEvent(const SDL_Event &event)
+{
+    static Uint64 lastArrowDownClick = 0;
 
-    while (SDL_PollEvent(&e))
+    switch (event.type)
     {
-        switch (e.type)
+    case SDL_QUIT:
+        exit = true;
+        break;
+    case SDL_WINDOWEVENT:
+        // The renderer checks its output size on every snapshot, a resize or a DPI change only needs one
+        redrawNeeded = true;
+        break;
+    case SDL_RENDER_TARGETS_RESET:
+    case SDL_RENDER_DEVICE_RESET:
+        renderResets++;
+        redrawNeeded = true;
+        break;
+    case SDL_KEYDOWN:
+        switch (event.key.keysym.sym)
         {
-        case SDL_QUIT:
-            exit = true;
+        case SDLK_UP:
+            keyPressed = ARROW_UP;
+            break;
+        case SDLK_RIGHT:
+            keyPressed = ARROW_RIGHT;
             break;
-        case SDL_WINDOWEVENT:
-            if (e.window.event == SDL_WINDOWEVENT_RESIZED)
+        case SDLK_DOWN:
+            keyPressed = ARROW_DOWN;
+            if (SDL_GetTicks64() - lastArrowDownClick < DOUBLE_CLICK_DELAY)
             {
-                handleGameResize();
+                lastArrowDownClick = 0;
+                hardDrop = true;
             }
-            break;
-        case SDL_KEYDOWN:
-            switch (e.key.keysym.sym)
+            else
             {
-            case SDLK_UP:
-                keyPressed = ARROW_UP;
-                break;
-            case SDLK_RIGHT:
-                keyPressed = ARROW_RIGHT;
-                break;
-            case SDLK_DOWN:
-                keyPressed = ARROW_DOWN;
-                if (SDL_GetTicks64() - lastArrowDownClick < 500)
-                {
-                    lastArrowDownClick = 0;
-                }
-                else
-                {
-                    lastArrowDownClick = SDL_GetTicks64();
-                }
-                break;
-            case SDLK_LEFT:
-                keyPressed = ARROW_LEFT;
-                break;
+                lastArrowDownClick = SDL_GetTicks64();
             }
             break;
+        case SDLK_LEFT:
+            keyPressed = ARROW_LEFT;
+            break;
+        case SDLK_SPACE:
+            hardDrop = true;
+            break;
         }
+        break;
     }
 }
 void Game::update()
+{
+    advance(SDL_GetTicks64() - startTime);
+}
+void Game::step(arrows action, Uint64 stepTime, bool drop /*= false*/)
+{
+    keyPressed = action;
+    hardDrop = drop;
+
+    advance(currentFrameTime + stepTime);
+}
+// Runs one frame of the game, with %gameTime% milisecounds since the game started
+void Game::advance(Uint64 gameTime)
 {
     bool blockMovedPlayer = false;
+    // The move or rotation went through, a key against a wall does not count
+    bool blockMoved = false;
 
     switch (keyPressed)
     {
@@ -174,16 +292,24 @@ void Game::update()
         if (!currentBlock.checkColisionLeft())
         {
             currentBlock.pos.x--;
+            blockMoved = true;
+            playSound(SOUND_MOVE);
         }
         break;
     case ARROW_RIGHT:
         if (!currentBlock.checkColisionRight())
         {
             currentBlock.pos.x++;
+            blockMoved = true;
+            playSound(SOUND_MOVE);
         }
         break;
     case ARROW_UP:
-        currentBlock.rotate();
+        if (currentBlock.rotate())
+        {
+            blockMoved = true;
+            playSound(SOUND_ROTATE);
+        }
         break;
     }
 
@@ -194,167 +320,273 @@ void Game::update()
 
     // Time handle
     Uint64 lastFrameTime = currentFrameTime;
-    currentFrameTime = SDL_GetTicks64() - startTime;
-    currentFrameTimeTexture.loadTextTexture(getCurrentTimeStr(), {0, 0, 0, SDL_ALPHA_OPAQUE}, gFont);
+    currentFrameTime = gameTime;
 
-    // In milisecounds
-    const int autoFallFrequency = 750;
+    // Gravity adds fractions of a row every frame, soft drop a whole row
+    gravityRows = std::min(gravityRows + (currentFrameTime - lastFrameTime) * rowsPerMs, static_cast<float>(ROWS_QUANTITY));
 
-    // When less than %autoFallFrequency% passed since last frame
-    bool blockAutoMoved1 = currentFrameTime % autoFallFrequency < lastFrameTime % autoFallFrequency;
-    // When more than %autoFallFrequency% passed since last frame (in case of a lag)
-    bool blockAutoMoved2 = currentFrameTime - lastFrameTime > autoFallFrequency;
-
-    bool blockAutoMoved = blockAutoMoved1 || blockAutoMoved2;
-
-    if (blockAutoMoved || blockMovedPlayer)
+    if (keyPressed == ARROW_DOWN)
     {
-        if (currentBlock.isPlaced())
-        {
-            placedCells.placeBlock(currentBlock.pos, currentBlock.cells, currentBlock.color);
+        gravityRows++;
+    }
 
-            currentBlock.cells = getBlockTypeCells(nextBlock);
-            currentBlock.color = getBlockTypeColor(nextBlock);
+    int rowsToFall = gravityRows;
+    gravityRows -= rowsToFall;
 
-            nextBlock = static_cast<blockTypesNames>(rand() % BLOCK_TYPES_TOTAL);
+    // A single query covers every row fallen this frame, however high the gravity
+    int dropDistance = getDropDistance();
+    int rowsFallen = hardDrop ? dropDistance : std::min(rowsToFall, dropDistance);
 
-            currentBlock.reset();
+    currentBlock.pos.y += rowsFallen;
 
-            std::vector<int> filledRows = placedCells.getFilledRows();
+    if (rowsFallen != 0 || blockMovedPlayer || hardDrop)
+    {
+        redrawNeeded = true;
+    }
 
-            exit = placedCells.isLost();
+    if (telemetry != nullptr && (blockMovedPlayer || hardDrop))
+    {
+        telemetry->recordInput(currentFrameTime, hardDrop ? "hard_drop" : getArrowName(keyPressed));
+    }
 
-            if (!filledRows.empty())
-            {
-                placedCells.clearRows(filledRows);
+    if (hardDrop || (keyPressed == ARROW_DOWN && dropDistance == 0))
+    {
+        lockCurrentBlock();
+    }
+    else if (dropDistance > rowsFallen)
+    {
+        blockResting = false;
+    }
+    else
+    {
+        // Resting on the stack, gravity waits for the lock delay
+        gravityRows = 0;
 
-                int pointsGained = calcPoints(filledRows.size());
-                addPoints(pointsGained);
-            }
+        if (!blockResting)
+        {
+            blockResting = true;
+            lockDelayStart = currentFrameTime;
         }
-        else if (blockAutoMoved || keyPressed == ARROW_DOWN)
+        else if (blockMoved && lockResets < LOCK_RESETS_MAX)
         {
-            currentBlock.pos.y++;
+            // Moving or rotating a resting block buys it more time
+            lockDelayStart = currentFrameTime;
+            lockResets++;
         }
-    }
-}
-void Game::render()
-{
-    SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, SDL_ALPHA_OPAQUE);
-    SDL_RenderClear(gRenderer);
 
-    SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, SDL_ALPHA_OPAQUE);
-    SDL_RenderDrawRect(gRenderer, &gameViewPort);
-
-    int currentTimeTextureX = (gameViewPort.x + gameViewPort.w) + (generalViewPort.w - (gameViewPort.x + gameViewPort.w)) * (2.0 / 3.0) - currentFrameTimeTexture.getHeight();
-    int currentTimeTextureY = generalViewPort.y;
-    currentFrameTimeTexture.render(currentTimeTextureX, currentTimeTextureY, nullptr);
-
-    int pointsTextureX = (gameViewPort.x + gameViewPort.w) + (generalViewPort.w - (gameViewPort.x + gameViewPort.w)) * (1.0 / 3.0) - pointsTexture.getWidth();
-    int pointsTextureY = gameViewPort.y;
-    pointsTexture.render(pointsTextureX, pointsTextureY, nullptr);
-
-    SDL_RenderSetViewport(gRenderer, &gameViewPort);
+        if (currentFrameTime - lockDelayStart >= LOCK_DELAY)
+        {
+            lockCurrentBlock();
+        }
+    }
 
-    drawCurrentBlock();
-    drawPlacedCells();
+    // The clock is rounded to its resolution, publish when the displayed value changes
+    Uint64 clockResolution = getClockResolution();
+    Uint64 clock = (currentFrameTime + clockResolution / 2) / clockResolution;
 
-    SDL_RenderSetViewport(gRenderer, &generalViewPort);
+    if (clock != publishedClock)
+    {
+        publishedClock = clock;
+        redrawNeeded = true;
+    }
 
-    drawNextBlock();
+    if (redrawNeeded && snapshots != nullptr)
+    {
+        publishSnapshot();
+    }
 
-    SDL_RenderPresent(gRenderer);
+    // The keys of this frame are used up
+    keyPressed = ARROW_NONE;
+    hardDrop = false;
+}
+void Game::enableIdleMode()
+{
+    clockDecimals = 1;
+}
+// Milisecounds between two changes of the displayed clock
+Uint64 Game::getClockResolution()
+{
+    return clockDecimals == 1 ? 100 : 10;
 }
-void Game::drawCell(SDL_Point coords, SDL_Color color)
+// Milisecounds until the block falls or locks, or the displayed clock changes
+int Game::getIdleTimeout()
 {
-    SDL_SetRenderDrawColor(gRenderer, color.r, color.g, color.b, color.a);
+    Uint64 gameTime = SDL_GetTicks64() - startTime;
+    Uint64 clockResolution = getClockResolution();
 
-    SDL_Rect cellRect;
+    Uint64 nextFall;
+    if (blockResting)
+    {
+        nextFall = lockDelayStart + LOCK_DELAY;
+    }
+    else
+    {
+        nextFall = currentFrameTime + static_cast<Uint64>(std::ceil((1 - gravityRows) / rowsPerMs));
+    }
 
-    cellRect.x = cellW * coords.x + 1;
-    cellRect.y = cellH * coords.y + 1;
+    // The clock is rounded, so its text changes halfway between two steps
+    Uint64 nextClockChange = (gameTime + clockResolution / 2) / clockResolution * clockResolution + clockResolution / 2;
 
-    cellRect.w = cellW - 2;
-    cellRect.h = cellH - 2;
+    Uint64 nextDeadline = std::min(nextFall, nextClockChange);
 
-    SDL_RenderFillRect(gRenderer, &cellRect);
-    SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, SDL_ALPHA_TRANSPARENT);
-    // SDL_RenderDrawRect(gRenderer, &cellRect);
+    return nextDeadline > gameTime ? nextDeadline - gameTime : 0;
 }
-void Game::handleGameResize()
+// Guideline gravity curve, scaled so level 1 falls one row every AUTO_FALL_FREQUENCY and capped at 20G
+void Game::calcGravity()
 {
-    int screenW, screenH;
+    float msPerRow = AUTO_FALL_FREQUENCY * std::pow(0.8F - (level - 1) * 0.007F, level - 1);
 
-    SDL_GetWindowSize(gWindow, &screenW, &screenH);
-
-    gameViewPort = {25, 0, 350, 700};
-    gameViewPort.y = (screenH - gameViewPort.h) / 2;
-
-    cellW = gameViewPort.w / COLUMNS_QUANTITY;
-    cellH = gameViewPort.h / ROWS_QUANTITY;
+    rowsPerMs = std::min(1 / msPerRow, GRAVITY_20G);
 }
-void Game::drawCurrentBlock()
+const char *Game::getArrowName(arrows arrow)
 {
-    for (auto cell : currentBlock.cells)
+    switch (arrow)
     {
-        SDL_Point cellDrawPoint = {cell.x + currentBlock.pos.x, cell.y + currentBlock.pos.y};
-
-        drawCell(cellDrawPoint, currentBlock.color);
+    case ARROW_UP:
+        return "up";
+    case ARROW_RIGHT:
+        return "right";
+    case ARROW_DOWN:
+        return "down";
+    case ARROW_LEFT:
+        return "left";
+    default:
+        return "none";
     }
 }
-void Game::drawPlacedCells()
+void Game::playSound(soundEffects effect)
 {
-    for (auto placedCell : placedCells.cells)
+    if (mixer != nullptr)
+    {
+        mixer->play(effect);
+    }
+}
+blockTypesNames Game::getRandomBlockType()
+{
+    return static_cast<blockTypesNames>(randomEngine() % BLOCK_TYPES_TOTAL);
+}
+// Rows the current block can fall before it lands, from the column heights of the stack
+int Game::getDropDistance()
+{
+    int dropDistance = ROWS_QUANTITY;
+
+    for (int column = 0; column < currentBlock.getWidth(); column++)
     {
-        SDL_Point cellCords = {placedCell.pos.x, placedCell.pos.y};
+        int blockBottom = currentBlock.pos.y + currentBlock.getBottom(column);
+        int landingRow = placedCells.getLandingRow(currentBlock.pos.x + column, blockBottom);
 
-        drawCell(cellCords, placedCell.color);
+        dropDistance = std::min(dropDistance, landingRow - blockBottom - 1);
     }
+    return dropDistance;
 }
-void Game::drawNextBlock()
+void Game::lockCurrentBlock()
 {
+    Uint64 lockStart = SDL_GetPerformanceCounter();
 
-    static blockTypesNames lastNextBlockType;
-    static std::array<SDL_Point, CELLS_IN_BLOCK> nextBlockCells;
-    static SDL_Color nextBlockColor;
-    static int nextBlockWidth;
+    placedCells.placeBlock(currentBlock.pos, currentBlock.cells, currentBlock.type);
 
-    if (lastNextBlockType != nextBlock)
+    currentBlock.type = nextBlock;
+    currentBlock.cells = getBlockTypeCells(nextBlock);
+
+    nextBlock = getRandomBlockType();
+
+    currentBlock.reset();
+
+    gravityRows = 0;
+    blockResting = false;
+    lockResets = 0;
+
+    placedCells.getFilledRows(rowsToClear);
+
+    bool lost = placedCells.isLost();
+    exit = exit || lost;
+
+    playSound(lost ? SOUND_GAME_OVER : rowsToClear.count != 0 ? SOUND_LINE_CLEAR : SOUND_LOCK);
+
+    if (rowsToClear.count != 0)
     {
-        lastNextBlockType = nextBlock;
-        nextBlockCells = getBlockTypeCells(nextBlock);
-        nextBlockColor = getBlockTypeColor(nextBlock);
+        placedCells.clearRows(rowsToClear);
 
-        nextBlockWidth = 0;
-        for (auto nextBlockCell : nextBlockCells)
+        int pointsGained = calcPoints(rowsToClear.count);
+        addPoints(pointsGained);
+
+        linesCleared += rowsToClear.count;
+        level = std::min(linesCleared / LINES_PER_LEVEL + 1, MAX_LEVEL);
+        calcGravity();
+    }
+
+    if (telemetry != nullptr)
+    {
+        Uint32 lockToSpawn = (SDL_GetPerformanceCounter() - lockStart) * 1000000 / SDL_GetPerformanceFrequency();
+
+        telemetry->recordLock(currentFrameTime, rowsToClear.count, placedCells.getStackHeight(), lockToSpawn);
+
+        if (lost)
         {
-            nextBlockWidth = std::max(nextBlockCell.x, nextBlockWidth);
+            telemetry->recordGameOver(currentFrameTime);
         }
-        nextBlockWidth++;
     }
+}
+void Game::publishSnapshot()
+{
+    renderSnapshot &snapshot = snapshots->back();
 
-    for (auto nextBlockCell : nextBlockCells)
-    {
-        int nextBlockCellSize = 50;
-        // TO RENAME
-        int gameMargin = gameViewPort.w + gameViewPort.x;
-        int infoWidth = generalViewPort.w - gameMargin;
+    snapshot.placedCells = placedCells;
+
+    snapshot.blockCells = currentBlock.cells;
+    snapshot.blockPos = currentBlock.pos;
+    snapshot.blockType = currentBlock.type;
+    snapshot.ghostY = currentBlock.pos.y + getDropDistance();
+    snapshot.blockFallProgress = gravityRows;
+
+    snapshot.nextBlockCells = getBlockTypeCells(nextBlock);
+    snapshot.nextBlockType = nextBlock;
 
-        int nextBlockY = generalViewPort.h / 2;
+    snapshot.points = points;
+    snapshot.time = currentFrameTime;
+    snapshot.clockDecimals = clockDecimals;
 
-        // TO RENAME
-        int infoCenter = (infoWidth - nextBlockWidth * nextBlockCellSize) / 2;
+    snapshot.renderResets = renderResets;
 
-        SDL_Rect nextBlockRenderRect;
+    snapshots->publish();
+    redrawNeeded = false;
+}
+int Game::getPoints()
+{
+    return points;
+}
+void Game::writeObservation(float *observation)
+{
+    float *placedPlane = observation;
+    float *blockPlane = placedPlane + OBSERVATION_PLANE_SIZE;
+    float *blockType = blockPlane + OBSERVATION_PLANE_SIZE;
+    float *nextBlockType = blockType + BLOCK_TYPES_TOTAL;
+
+    std::fill(observation, observation + OBSERVATION_SIZE, 0.0F);
 
-        nextBlockRenderRect.x = gameMargin + infoCenter + nextBlockCellSize * nextBlockCell.x + 1;
-        nextBlockRenderRect.y = nextBlockY + nextBlockCellSize * nextBlockCell.y + 1;
-        nextBlockRenderRect.w = nextBlockCellSize - 2;
-        nextBlockRenderRect.h = nextBlockCellSize - 2;
+    for (int row = 0; row < ROWS_QUANTITY; row++)
+    {
+        Uint16 occupied = placedCells.getRow(row);
 
-        SDL_SetRenderDrawColor(gRenderer, nextBlockColor.r, nextBlockColor.g, nextBlockColor.b, nextBlockColor.a);
-        SDL_RenderFillRect(gRenderer, &nextBlockRenderRect);
+        for (int column = 0; column < COLUMNS_QUANTITY; column++)
+        {
+            placedPlane[row * COLUMNS_QUANTITY + column] = (occupied >> column) & 1;
+        }
     }
+
+    for (auto blockCell : currentBlock.cells)
+    {
+        int x = currentBlock.pos.x + blockCell.x;
+        int y = currentBlock.pos.y + blockCell.y;
+
+        if (y >= 0 && y < ROWS_QUANTITY)
+        {
+            blockPlane[y * COLUMNS_QUANTITY + x] = 1;
+        }
+    }
+
+    blockType[currentBlock.type] = 1;
+    nextBlockType[nextBlock] = 1;
 }
 int Game::calcPoints(int rowsCleared)
 {
@@ -382,10 +614,6 @@ int Game::calcPoints(int rowsCleared)
 void Game::addPoints(int pointsToAdd)
 {
     points += pointsToAdd;
-
-    // Update points texture
-    SDL_Color pointsTextureColor = {0, 0, 0, SDL_ALPHA_OPAQUE};
-    pointsTexture.loadTextTexture(std::to_string(points), pointsTextureColor, gFont);
 }
 SDL_Color Game::getBlockTypeColor(blockTypesNames blockType)
 {
@@ -445,13 +673,4 @@ std::array<SDL_Point, CELLS_IN_BLOCK> Game::getBlockTypeCells(blockTypesNames bl
     }
     return cells;
 }
-std::string Game::getCurrentTimeStr()
-{
-    float currentTimeFormated = std::round(currentFrameTime / 10.0F) / 100;
-
-    std::string currentTimeStr = std::to_string(currentTimeFormated);
-    int dotIndex = currentTimeStr.find('.') + 1;
-    currentTimeStr.erase(dotIndex + 2, currentTimeStr.length() - dotIndex);
-
-    return currentTimeStr;
-}
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -0,0 +1,437 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "./texture.hpp"
+#include "./cellAtlas.hpp"
+#include "./textRasterizer.hpp"
+#include "./tripleBuffer.hpp"
+#include "./renderSnapshot.hpp"
+#include "./game.hpp"
+
+#ifndef GAME_RENDERER_HPP
+#define GAME_RENDERER_HPP
+
+// Layout of the original 675x750 window, scaled as a whole to fit the renderer output
+#define LAYOUT_WIDTH 675
+#define LAYOUT_HEIGHT 750
+#define LAYOUT_BOARD_X 25
+#define LAYOUT_CELL_SIZE 35
+#define NEXT_BLOCK_CELL_SIZE 50
+#define HUD_FONT_SIZE 50
+
+// Every character the HUD shows, rasterized once per font size
+#define HUD_GLYPHS "0123456789.-"
+
+// Smallest cell in pixels, leaves room for the 1 pixel gap on both sides
+#define MIN_CELL_SIZE 4
+
+// Every cell of the board plus the ghost, the current and the next block
+#define CELL_QUADS_CAPACITY (ROWS_QUANTITY * COLUMNS_QUANTITY + 3 * CELLS_IN_BLOCK)
+
+// Draws the latest published snapshot of the game. Owns everything tied to the
+// SDL renderer, so it has to live on the thread that created that renderer.
+class GameRenderer
+{
+private:
+    SDL_Renderer *gRenderer;
+
+    TripleBuffer<renderSnapshot> &snapshots;
+    bool hasSnapshot = false;
+
+    bool interpolate = false;
+
+    // Renderer output size of the last layout, in pixels
+    int outputW = 0, outputH = 0;
+    // Render resets of the snapshot the textures were last made for
+    Uint32 renderResets = 0;
+
+    // Layout in renderer output pixels, only recomputed when the output size changes
+    int cellW, cellH;
+    int nextBlockCellSize;
+
+    SDL_Rect gameViewPort;
+    SDL_Rect generalViewPort;
+
+    // HUD texts hang left of these points, the next block is centered on its point
+    SDL_Point currentTimeAnchor;
+    SDL_Point pointsAnchor;
+    SDL_Point nextBlockAnchor;
+
+    // The clock and the points are cut glyph by glyph out of this texture, so a changed text needs no new texture
+    GTexture hudGlyphsTexture;
+
+    TextRasterizer textRasterizer;
+
+    CellAtlas cellAtlas;
+
+    // Every cell of a frame, drawn as textured quads with a single SDL_RenderGeometry call
+    std::array<SDL_Vertex, CELL_QUADS_CAPACITY * 4> cellVertices;
+    std::array<int, CELL_QUADS_CAPACITY * 6> cellIndices;
+    int cellQuadsCount = 0;
+
+    void handleGameResize();
+    void formatCurrentTime(const renderSnapshot &snapshot, char *timeText, size_t timeTextLength);
+    void drawHudText(const char *text, int x, int y);
+    int getHudTextWidth(const char *text);
+
+    void drawCurrentBlock(const renderSnapshot &snapshot);
+    void drawGhostBlock(const renderSnapshot &snapshot);
+    void drawPlacedCells(const renderSnapshot &snapshot);
+    void drawNextBlock(const renderSnapshot &snapshot);
+    void drawCell(SDL_Point cords, int tile, blockTypesNames blockType, int offsetY = 0);
+    void addCellQuad(SDL_Rect cellRect, SDL_FRect tile, SDL_Color color);
+
+    SDL_Color getCellColor(int tile, blockTypesNames blockType);
+    SDL_Color getGhostColor(SDL_Color blockColor);
+
+public:
+    GameRenderer(SDL_Renderer *loadRenderer, TTF_Font *loadFont, TripleBuffer<renderSnapshot> &loadSnapshots);
+
+    // Draw the falling block between rows according to its gravity progress
+    void enableInterpolation();
+
+    // Returns false when neither the snapshot nor the HUD changed and nothing was drawn
+    bool render();
+    // Every requested HUD text is on screen, the next text upload would allocate
+    bool isHudReady();
+};
+GameRenderer::GameRenderer(SDL_Renderer *loadRenderer, TTF_Font *loadFont, TripleBuffer<renderSnapshot> &loadSnapshots)
+    : gRenderer(loadRenderer),
+      snapshots(loadSnapshots),
+      hudGlyphsTexture(gRenderer),
+      textRasterizer(loadFont),
+      cellAtlas(loadRenderer)
+{
+    cellAtlas.load(CELL_ATLAS_PATH);
+
+    // Two triangles per quad, the same for every frame
+    for (int quad = 0; quad < CELL_QUADS_CAPACITY; quad++)
+    {
+        int *quadIndices = &cellIndices[quad * 6];
+        int firstVertex = quad * 4;
+
+        quadIndices[0] = firstVertex;
+        quadIndices[1] = firstVertex + 1;
+        quadIndices[2] = firstVertex + 2;
+        quadIndices[3] = firstVertex + 2;
+        quadIndices[4] = firstVertex + 3;
+        quadIndices[5] = firstVertex;
+    }
+}
+bool GameRenderer::isHudReady()
+{
+    return textRasterizer.isIdle();
+}
+void GameRenderer::enableInterpolation()
+{
+    interpolate = true;
+}
+bool GameRenderer::render()
+{
+    bool snapshotChanged = snapshots.acquire();
+    hasSnapshot = hasSnapshot || snapshotChanged;
+
+    if (!hasSnapshot)
+    {
+        return false;
+    }
+
+    const renderSnapshot &snapshot = snapshots.front();
+
+    bool layoutChanged = false;
+
+    // A reset loses what was drawn into the scaled atlas, a device reset every texture
+    if (snapshot.renderResets != renderResets)
+    {
+        renderResets = snapshot.renderResets;
+
+        cellAtlas.load(CELL_ATLAS_PATH);
+        layoutChanged = true;
+    }
+
+    // Moving the window to a display with another DPI changes the pixels but not the window size
+    int currentOutputW, currentOutputH;
+    if (SDL_GetRendererOutputSize(gRenderer, &currentOutputW, &currentOutputH) < 0)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+    }
+    else if (currentOutputW != outputW || currentOutputH != outputH)
+    {
+        outputW = currentOutputW;
+        outputH = currentOutputH;
+        layoutChanged = true;
+    }
+
+    if (layoutChanged)
+    {
+        handleGameResize();
+    }
+
+    bool hudChanged = textRasterizer.uploadReady();
+
+    if (!snapshotChanged && !hudChanged && !layoutChanged)
+    {
+        return false;
+    }
+
+    SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, SDL_ALPHA_OPAQUE);
+    SDL_RenderClear(gRenderer);
+
+    SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, SDL_ALPHA_OPAQUE);
+    SDL_RenderDrawRect(gRenderer, &gameViewPort);
+
+    char timeText[HUD_TEXT_LENGTH];
+    formatCurrentTime(snapshot, timeText, HUD_TEXT_LENGTH);
+
+    char pointsText[HUD_TEXT_LENGTH];
+    snprintf(pointsText, HUD_TEXT_LENGTH, "%d", snapshot.points);
+
+    drawHudText(timeText, currentTimeAnchor.x - hudGlyphsTexture.getHeight(), currentTimeAnchor.y);
+    drawHudText(pointsText, pointsAnchor.x - getHudTextWidth(pointsText), pointsAnchor.y);
+
+    cellQuadsCount = 0;
+
+    drawGhostBlock(snapshot);
+    drawCurrentBlock(snapshot);
+    drawPlacedCells(snapshot);
+    drawNextBlock(snapshot);
+
+    SDL_RenderGeometry(gRenderer, cellAtlas.getTexture(), cellVertices.data(), cellQuadsCount * 4, cellIndices.data(), cellQuadsCount * 6);
+
+    SDL_RenderPresent(gRenderer);
+    return true;
+}
+// Game time in seconds with %clockDecimals% decimals, formatted into a caller owned buffer
+void GameRenderer::formatCurrentTime(const renderSnapshot &snapshot, char *timeText, size_t timeTextLength)
+{
+    float clockResolution = snapshot.clockDecimals == 1 ? 100 : 10;
+    float currentTimeFormated = std::round(snapshot.time / clockResolution) * clockResolution / 1000;
+
+    snprintf(timeText, timeTextLength, "%.*f", snapshot.clockDecimals, currentTimeFormated);
+}
+// Draws %text% from the HUD glyphs, characters missing from HUD_GLYPHS are skipped
+void GameRenderer::drawHudText(const char *text, int x, int y)
+{
+    const int *glyphsX = textRasterizer.getGlyphsX(&hudGlyphsTexture);
+
+    if (hudGlyphsTexture.getTexture() == nullptr || glyphsX == nullptr)
+    {
+        return;
+    }
+
+    for (const char *character = text; *character != '\0'; character++)
+    {
+        const char *glyph = strchr(HUD_GLYPHS, *character);
+        if (glyph == nullptr)
+        {
+            continue;
+        }
+
+        int glyphIndex = glyph - HUD_GLYPHS;
+        SDL_Rect glyphClip = {glyphsX[glyphIndex], 0, glyphsX[glyphIndex + 1] - glyphsX[glyphIndex], hudGlyphsTexture.getHeight()};
+
+        hudGlyphsTexture.render(x, y, &glyphClip);
+        x += glyphClip.w;
+    }
+}
+int GameRenderer::getHudTextWidth(const char *text)
+{
+    const int *glyphsX = textRasterizer.getGlyphsX(&hudGlyphsTexture);
+
+    if (glyphsX == nullptr)
+    {
+        return 0;
+    }
+
+    int textWidth = 0;
+    for (const char *character = text; *character != '\0'; character++)
+    {
+        const char *glyph = strchr(HUD_GLYPHS, *character);
+        if (glyph != nullptr)
+        {
+            textWidth += glyphsX[glyph - HUD_GLYPHS + 1] - glyphsX[glyph - HUD_GLYPHS];
+        }
+    }
+    return textWidth;
+}
+// Queues a cell of the board, %coords% in cells
+void GameRenderer::drawCell(SDL_Point coords, int tile, blockTypesNames blockType, int offsetY /*= 0*/)
+{
+    SDL_Rect cellRect;
+
+    cellRect.x = gameViewPort.x + cellW * coords.x + 1;
+    cellRect.y = gameViewPort.y + cellH * coords.y + 1 + offsetY;
+
+    cellRect.w = cellW - 2;
+    cellRect.h = cellH - 2;
+
+    // The board viewport used to hide the rows above the board, now the quad is cut at its top
+    int hiddenH = gameViewPort.y - cellRect.y;
+    if (hiddenH >= cellRect.h)
+    {
+        return;
+    }
+
+    SDL_FRect tileCoords = cellAtlas.getTile(tile, false);
+    if (hiddenH > 0)
+    {
+        float hiddenPart = static_cast<float>(hiddenH) / cellRect.h;
+
+        tileCoords.y += tileCoords.h * hiddenPart;
+        tileCoords.h -= tileCoords.h * hiddenPart;
+        cellRect.y += hiddenH;
+        cellRect.h -= hiddenH;
+    }
+
+    addCellQuad(cellRect, tileCoords, getCellColor(tile, blockType));
+}
+void GameRenderer::addCellQuad(SDL_Rect cellRect, SDL_FRect tile, SDL_Color color)
+{
+    SDL_Vertex *quadVertices = &cellVertices[cellQuadsCount * 4];
+
+    quadVertices[0] = {{static_cast<float>(cellRect.x), static_cast<float>(cellRect.y)}, color, {tile.x, tile.y}};
+    quadVertices[1] = {{static_cast<float>(cellRect.x + cellRect.w), static_cast<float>(cellRect.y)}, color, {tile.x + tile.w, tile.y}};
+    quadVertices[2] = {{static_cast<float>(cellRect.x + cellRect.w), static_cast<float>(cellRect.y + cellRect.h)}, color, {tile.x + tile.w, tile.y + tile.h}};
+    quadVertices[3] = {{static_cast<float>(cellRect.x), static_cast<float>(cellRect.y + cellRect.h)}, color, {tile.x, tile.y + tile.h}};
+
+    cellQuadsCount++;
+}
+// Fits the original layout into the output, on high DPI displays the output has more pixels than the window
+void GameRenderer::handleGameResize()
+{
+    SDL_RenderSetViewport(gRenderer, nullptr);
+
+    float scale = std::min(static_cast<float>(outputW) / LAYOUT_WIDTH, static_cast<float>(outputH) / LAYOUT_HEIGHT);
+
+    // Whole pixel cells keep the board and the cell skins sharp
+    cellW = std::max(static_cast<int>(LAYOUT_CELL_SIZE * scale), MIN_CELL_SIZE);
+    cellH = cellW;
+    nextBlockCellSize = std::max(static_cast<int>(NEXT_BLOCK_CELL_SIZE * scale), MIN_CELL_SIZE);
+
+    generalViewPort.w = LAYOUT_WIDTH * scale;
+    generalViewPort.h = LAYOUT_HEIGHT * scale;
+    generalViewPort.x = (outputW - generalViewPort.w) / 2;
+    generalViewPort.y = (outputH - generalViewPort.h) / 2;
+
+    gameViewPort.w = cellW * COLUMNS_QUANTITY;
+    gameViewPort.h = cellH * ROWS_QUANTITY;
+    gameViewPort.x = generalViewPort.x + static_cast<int>(LAYOUT_BOARD_X * scale);
+    gameViewPort.y = generalViewPort.y + (generalViewPort.h - gameViewPort.h) / 2;
+
+    // The HUD sits in the space right of the board
+    int infoX = gameViewPort.x + gameViewPort.w;
+    int infoWidth = generalViewPort.x + generalViewPort.w - infoX;
+
+    currentTimeAnchor = {infoX + infoWidth * 2 / 3, generalViewPort.y};
+    pointsAnchor = {infoX + infoWidth / 3, gameViewPort.y};
+    nextBlockAnchor = {infoX + infoWidth / 2, generalViewPort.y + generalViewPort.h / 2};
+
+    // Cells are drawn inset by a pixel on every side
+    cellAtlas.rescale(cellW - 2, cellH - 2, nextBlockCellSize - 2);
+
+    // Rasterize the HUD glyphs again at the new font size
+    SDL_Color hudTextColor = {0, 0, 0, SDL_ALPHA_OPAQUE};
+
+    textRasterizer.setFontSize(std::max(static_cast<int>(HUD_FONT_SIZE * scale), 1));
+    textRasterizer.request(&hudGlyphsTexture, HUD_GLYPHS, hudTextColor);
+}
+void GameRenderer::drawCurrentBlock(const renderSnapshot &snapshot)
+{
+    // Never interpolate past the row the block lands on
+    int offsetY = 0;
+    if (interpolate && snapshot.ghostY > snapshot.blockPos.y)
+    {
+        offsetY = snapshot.blockFallProgress * cellH;
+    }
+
+    for (auto cell : snapshot.blockCells)
+    {
+        SDL_Point cellDrawPoint = {cell.x + snapshot.blockPos.x, cell.y + snapshot.blockPos.y};
+
+        drawCell(cellDrawPoint, snapshot.blockType, snapshot.blockType, offsetY);
+    }
+}
+void GameRenderer::drawGhostBlock(const renderSnapshot &snapshot)
+{
+    for (auto cell : snapshot.blockCells)
+    {
+        SDL_Point cellDrawPoint = {cell.x + snapshot.blockPos.x, cell.y + snapshot.ghostY};
+
+        drawCell(cellDrawPoint, CELL_TILE_GHOST, snapshot.blockType);
+    }
+}
+void GameRenderer::drawPlacedCells(const renderSnapshot &snapshot)
+{
+    for (int row = 0; row < ROWS_QUANTITY; row++)
+    {
+        Uint16 occupied = snapshot.placedCells.getRow(row);
+
+        for (int column = 0; occupied != 0; column++, occupied >>= 1)
+        {
+            if (occupied & 1)
+            {
+                blockTypesNames blockType = static_cast<blockTypesNames>(snapshot.placedCells.getType(column, row));
+
+                drawCell({column, row}, blockType, blockType);
+            }
+        }
+    }
+}
+void GameRenderer::drawNextBlock(const renderSnapshot &snapshot)
+{
+    int nextBlockWidth = 0;
+    for (auto nextBlockCell : snapshot.nextBlockCells)
+    {
+        nextBlockWidth = std::max(nextBlockCell.x, nextBlockWidth);
+    }
+    nextBlockWidth++;
+
+    SDL_Color nextBlockColor = getCellColor(snapshot.nextBlockType, snapshot.nextBlockType);
+    SDL_FRect nextBlockTile = cellAtlas.getTile(snapshot.nextBlockType, true);
+
+    int nextBlockX = nextBlockAnchor.x - nextBlockWidth * nextBlockCellSize / 2;
+
+    for (auto nextBlockCell : snapshot.nextBlockCells)
+    {
+        SDL_Rect nextBlockRenderRect;
+
+        nextBlockRenderRect.x = nextBlockX + nextBlockCellSize * nextBlockCell.x + 1;
+        nextBlockRenderRect.y = nextBlockAnchor.y + nextBlockCellSize * nextBlockCell.y + 1;
+        nextBlockRenderRect.w = nextBlockCellSize - 2;
+        nextBlockRenderRect.h = nextBlockCellSize - 2;
+
+        addCellQuad(nextBlockRenderRect, nextBlockTile, nextBlockColor);
+    }
+}
+// Vertex color of a cell. Block skins carry their own colors and the ghost skin is
+// tinted with the block color, without an atlas the quads are filled with plain colors.
+SDL_Color GameRenderer::getCellColor(int tile, blockTypesNames blockType)
+{
+    SDL_Color blockColor = Game::getBlockTypeColor(blockType);
+
+    if (cellAtlas.getTexture() == nullptr)
+    {
+        return tile == CELL_TILE_GHOST ? getGhostColor(blockColor) : blockColor;
+    }
+    return tile == CELL_TILE_GHOST ? blockColor : SDL_Color{0xFF, 0xFF, 0xFF, SDL_ALPHA_OPAQUE};
+}
+// Faded version of the block color, blended towards the white background
+SDL_Color GameRenderer::getGhostColor(SDL_Color blockColor)
+{
+    SDL_Color ghostColor;
+
+    ghostColor.r = (blockColor.r + 0xFF * 3) / 4;
+    ghostColor.g = (blockColor.g + 0xFF * 3) / 4;
+    ghostColor.b = (blockColor.b + 0xFF * 3) / 4;
+    ghostColor.a = blockColor.a;
+
+    return ghostColor;
+}
+#endif
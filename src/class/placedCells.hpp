@@ -1,100 +1,190 @@
 #include <SDL2/SDL.h>
 
-#include <iostream>
-#include <vector>
-#include <map>
+#include <algorithm>
 #include <array>
+#include <cstring>
+
+#ifndef PLACED_CELLS_HPP
+#define PLACED_CELLS_HPP
 
 #ifndef ROWS_QUANTITY
 #define ROWS_QUANTITY 20
 #define COLUMNS_QUANTITY 10
 #endif
 
-#ifndef CELL_STRUCT
-#define CELL_STRUCT
-typedef struct cell
+// Occupancy bits of a completely filled row, bit x is column x
+#define FULL_ROW ((1 << COLUMNS_QUANTITY) - 1)
+
+#ifndef FILLED_ROWS_STRUCT
+#define FILLED_ROWS_STRUCT
+typedef struct filledRows
 {
-    SDL_Point pos;
-    SDL_Color color;
-} cell;
+    std::array<int, ROWS_QUANTITY> rows;
+    int count = 0;
+} filledRows;
 #endif
 
+// The board as two dense planes: an occupancy bit per cell for the game logic and a
+// byte per cell with its block type, only read when drawing. Nothing but fixed arrays,
+// so copying a board is a couple of memcpys.
 class PlacedCells
 {
 public:
-    PlacedCells(std::vector<cell> &loadPlacedCells);
+    PlacedCells();
 
-    void placeBlock(SDL_Point blockPos, std::array<SDL_Point, 4> block, SDL_Color color);
-    void clearRows(std::vector<int> rowsToClear);
-    std::vector<int> getFilledRows();
-    std::vector<cell> &cells;
+    void placeBlock(SDL_Point blockPos, std::array<SDL_Point, 4> block, Uint8 type);
+    void clear();
+    void clearRows(const filledRows &rowsToClear);
+    void getFilledRows(filledRows &filledRowsFound);
     bool isLost();
+
+    // Below the board is the floor, everything else outside it is empty, blocks check the walls themselves
+    bool isOccupied(int column, int row) const;
+    Uint16 getRow(int row) const;
+    // blockTypesNames of an occupied cell
+    Uint8 getType(int column, int row) const;
+
+    int getLandingRow(int column, int fromRow);
+    int getStackHeight();
+
+private:
+    std::array<Uint16, ROWS_QUANTITY> rows;
+    std::array<Uint8, ROWS_QUANTITY * COLUMNS_QUANTITY> types;
+
+    // Highest occupied row in every column, ROWS_QUANTITY when the column is empty
+    std::array<int, COLUMNS_QUANTITY> columnsTop;
+
+    // A block was placed reaching the top row, cells above the board are not kept
+    bool lost;
+
+    void calcColumnsTop();
 };
-PlacedCells::PlacedCells(std::vector<cell> &loadPlacedCells) : cells(loadPlacedCells)
+PlacedCells::PlacedCells()
 {
+    clear();
 }
-std::vector<int> PlacedCells::getFilledRows()
+void PlacedCells::clear()
 {
-    std::map<int, int> rowsLength;
+    rows.fill(0);
+    types.fill(0);
+    lost = false;
 
-    for (auto placedCell : cells)
-    {
-        rowsLength[placedCell.pos.y]++;
-    }
-    std::vector<int> filledRows;
-    for (auto [rowIndex, rowLength] : rowsLength)
+    calcColumnsTop();
+}
+void PlacedCells::getFilledRows(filledRows &filledRowsFound)
+{
+    filledRowsFound.count = 0;
+    for (int rowIndex = 0; rowIndex < ROWS_QUANTITY; rowIndex++)
     {
-        if (rowLength == COLUMNS_QUANTITY)
+        if (rows[rowIndex] == FULL_ROW)
         {
-            filledRows.push_back(rowIndex);
+            filledRowsFound.rows[filledRowsFound.count++] = rowIndex;
         }
     }
-    return filledRows;
 }
 bool PlacedCells::isLost()
 {
-    bool isGameLost = false;
-    for (auto placedCell : cells)
+    return lost;
+}
+void PlacedCells::placeBlock(SDL_Point blockPos, std::array<SDL_Point, 4> block, Uint8 type)
+{
+    for (auto blockCell : block)
     {
-        if (placedCell.pos.y <= 0)
+        int column = blockCell.x + blockPos.x;
+        int row = blockCell.y + blockPos.y;
+
+        if (row <= 0)
+        {
+            lost = true;
+        }
+
+        if (row < 0 || row >= ROWS_QUANTITY || column < 0 || column >= COLUMNS_QUANTITY)
         {
-            isGameLost = true;
-            break;
+            continue;
         }
+
+        rows[row] |= 1 << column;
+        types[row * COLUMNS_QUANTITY + column] = type;
+
+        columnsTop[column] = std::min(columnsTop[column], row);
     }
-    return isGameLost;
 }
-void PlacedCells::placeBlock(SDL_Point blockPos, std::array<SDL_Point, 4> block, SDL_Color color)
+// %rowsToClear% is sorted top to bottom, clearing a row never moves the ones below it
+void PlacedCells::clearRows(const filledRows &rowsToClear)
 {
-    for (auto blockCell : block)
+    for (int i = 0; i < rowsToClear.count; i++)
     {
-        cell cellToPlace;
+        int rowIndex = rowsToClear.rows[i];
 
-        cellToPlace.color = color;
-        cellToPlace.pos.x = blockCell.x + blockPos.x;
-        cellToPlace.pos.y = blockCell.y + blockPos.y;
+        // Everything above the cleared row falls by one
+        memmove(&rows[1], &rows[0], rowIndex * sizeof(rows[0]));
+        memmove(&types[COLUMNS_QUANTITY], &types[0], rowIndex * COLUMNS_QUANTITY * sizeof(types[0]));
 
-        cells.push_back(cellToPlace);
+        rows[0] = 0;
+        std::fill(types.begin(), types.begin() + COLUMNS_QUANTITY, 0);
     }
+    calcColumnsTop();
 }
-void PlacedCells::clearRows(std::vector<int> rowsToClear)
+void PlacedCells::calcColumnsTop()
 {
-    for (auto rowIndex : rowsToClear)
+    columnsTop.fill(ROWS_QUANTITY);
+
+    for (int row = ROWS_QUANTITY - 1; row >= 0; row--)
     {
-        for (int i = cells.size() - 1, columnsCleared = 0; columnsCleared < 10; i--)
+        for (int column = 0; column < COLUMNS_QUANTITY; column++)
         {
-            if (cells[i].pos.y == rowIndex)
+            if (rows[row] & (1 << column))
             {
-                cells.erase(cells.begin() + i);
-                columnsCleared++;
+                columnsTop[column] = row;
             }
         }
-        for (auto &placedCell : cells)
+    }
+}
+bool PlacedCells::isOccupied(int column, int row) const
+{
+    if (row >= ROWS_QUANTITY)
+    {
+        return true;
+    }
+    if (row < 0 || column < 0 || column >= COLUMNS_QUANTITY)
+    {
+        return false;
+    }
+    return rows[row] & (1 << column);
+}
+Uint16 PlacedCells::getRow(int row) const
+{
+    return rows[row];
+}
+Uint8 PlacedCells::getType(int column, int row) const
+{
+    return types[row * COLUMNS_QUANTITY + column];
+}
+int PlacedCells::getStackHeight()
+{
+    int stackTop = ROWS_QUANTITY;
+    for (auto columnTop : columnsTop)
+    {
+        stackTop = std::min(stackTop, columnTop);
+    }
+    return ROWS_QUANTITY - stackTop;
+}
+// Returns the first occupied row below %fromRow% in the given column (ROWS_QUANTITY for the floor)
+int PlacedCells::getLandingRow(int column, int fromRow)
+{
+    if (columnsTop[column] > fromRow)
+    {
+        return columnsTop[column];
+    }
+
+    // Block slid under an overhang, fall back to scanning the column
+    for (int row = std::max(fromRow + 1, 0); row < ROWS_QUANTITY; row++)
+    {
+        if (rows[row] & (1 << column))
         {
-            if (placedCell.pos.y < rowIndex)
-            {
-                placedCell.pos.y++;
-            }
+            return row;
         }
     }
-}
\ No newline at end of file
+    return ROWS_QUANTITY;
+}
+#endif
@@ -0,0 +1,34 @@
+#include <SDL2/SDL.h>
+
+#include <array>
+
+#include "./block.hpp"
+#include "./placedCells.hpp"
+
+#ifndef RENDER_SNAPSHOT_HPP
+#define RENDER_SNAPSHOT_HPP
+
+// Everything the renderer needs to draw one frame, copied out of the game so the
+// two can run on different threads
+typedef struct renderSnapshot
+{
+    PlacedCells placedCells;
+
+    std::array<SDL_Point, 4> blockCells;
+    SDL_Point blockPos;
+    blockTypesNames blockType;
+    int ghostY;
+    // Fraction of the next row the block has already fallen, for interpolation
+    float blockFallProgress;
+
+    std::array<SDL_Point, 4> nextBlockCells;
+    blockTypesNames nextBlockType;
+
+    int points;
+    Uint64 time;
+    int clockDecimals;
+
+    // Changes after SDL_RENDER_TARGETS_RESET or SDL_RENDER_DEVICE_RESET, textures may have lost their contents
+    Uint32 renderResets;
+} renderSnapshot;
+#endif
@@ -0,0 +1,147 @@
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <iostream>
+
+#include "./spscQueue.hpp"
+#include "./tripleBuffer.hpp"
+#include "./renderSnapshot.hpp"
+#include "./game.hpp"
+
+#ifndef SIM_THREAD_HPP
+#define SIM_THREAD_HPP
+
+#define SIM_EVENTS_CAPACITY 64
+
+// In milisecounds, longest the main thread sleeps in pumpEvents without a new snapshot or input
+#define SIM_PUMP_TIMEOUT 100
+
+// Runs the game on its own thread. The main thread keeps the event pump and the renderer,
+// as SDL wants, and hands input over through a lock-free queue, so a slow SDL_RenderPresent
+// never holds up the game update. The game publishes snapshots like it does on one thread.
+class SimThread
+{
+private:
+    Game &game;
+    TripleBuffer<renderSnapshot> &snapshots;
+
+    SpscQueue<SDL_Event, SIM_EVENTS_CAPACITY> events;
+
+    SDL_Thread *thread = nullptr;
+    SDL_sem *eventsSemaphore = nullptr;
+
+    std::atomic<bool> running;
+    std::atomic<bool> finished;
+
+    // Pushed after every update that left a fresh snapshot, wakes the main thread in pumpEvents
+    Uint32 snapshotEvent;
+
+    static int work(void *simThread);
+
+public:
+    // The game belongs to the thread from here on, only this class touches it
+    SimThread(Game &loadGame, TripleBuffer<renderSnapshot> &loadSnapshots);
+    ~SimThread();
+
+    // Main thread: sleeps until input, a new snapshot or %timeout% milisecounds, then hands the events to the game
+    void pumpEvents(int timeout);
+    // The game quit or was lost
+    bool isFinished();
+};
+SimThread::SimThread(Game &loadGame, TripleBuffer<renderSnapshot> &loadSnapshots)
+    : game(loadGame),
+      snapshots(loadSnapshots),
+      running(true),
+      finished(false)
+{
+    snapshotEvent = SDL_RegisterEvents(1);
+
+    eventsSemaphore = SDL_CreateSemaphore(0);
+    if (eventsSemaphore != nullptr)
+    {
+        thread = SDL_CreateThread(work, "Simulation", this);
+    }
+
+    if (thread == nullptr)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+        finished = true;
+    }
+}
+SimThread::~SimThread()
+{
+    running = false;
+
+    if (thread != nullptr)
+    {
+        SDL_SemPost(eventsSemaphore);
+        SDL_WaitThread(thread, nullptr);
+    }
+
+    SDL_DestroySemaphore(eventsSemaphore);
+}
+void SimThread::pumpEvents(int timeout)
+{
+    SDL_Event e;
+
+    if (!SDL_WaitEventTimeout(&e, timeout))
+    {
+        return;
+    }
+
+    bool inputQueued = false;
+    do
+    {
+        // User events, new snapshots and finished HUD text, only wake this thread
+        if (e.type >= SDL_USEREVENT)
+        {
+            continue;
+        }
+
+        // A full queue means the game thread is stalled, drop the input rather than wait
+        inputQueued = events.push(e) || inputQueued;
+    } while (SDL_PollEvent(&e));
+
+    if (inputQueued)
+    {
+        SDL_SemPost(eventsSemaphore);
+    }
+}
+bool SimThread::isFinished()
+{
+    return finished;
+}
+int SimThread::work(void *simThread)
+{
+    SimThread *self = static_cast<SimThread *>(simThread);
+    Game &game = self->game;
+
+    SDL_Event snapshotReady = {};
+    snapshotReady.type = self->snapshotEvent;
+
+    while (self->running && !game.exit)
+    {
+        // Sleeps until input or the next fall, lock or clock change
+        SDL_SemWaitTimeout(self->eventsSemaphore, game.getIdleTimeout());
+
+        SDL_Event event;
+        while (self->events.pop(event))
+        {
+            game.handleEvent(event);
+        }
+
+        game.update();
+
+        if (self->snapshots.hasFresh())
+        {
+            SDL_PushEvent(&snapshotReady);
+        }
+    }
+
+    self->finished = true;
+
+    // The main thread may be sleeping in pumpEvents
+    SDL_PushEvent(&snapshotReady);
+    return 0;
+}
+#endif
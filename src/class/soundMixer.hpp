@@ -0,0 +1,333 @@
+#include <SDL2/SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "./spscQueue.hpp"
+
+#ifndef SOUND_MIXER_HPP
+#define SOUND_MIXER_HPP
+
+#define MIXER_FREQUENCY 48000
+// Default and largest device buffer, in samples
+#define MIXER_BUFFER_SAMPLES 256
+#define MIXER_VOICES 8
+#define MIXER_QUEUE_CAPACITY 64
+
+// In milisecounds, how often closing checks whether the last voices finished
+#define MIXER_DRAIN_POLL 5
+
+enum soundEffects
+{
+    SOUND_MOVE,
+    SOUND_ROTATE,
+    SOUND_LOCK,
+    SOUND_LINE_CLEAR,
+    SOUND_GAME_OVER,
+    SOUND_EFFECTS_TOTAL
+};
+
+typedef struct soundCommand
+{
+    soundEffects effect;
+    Uint64 time;
+} soundCommand;
+
+typedef struct voice
+{
+    const Sint16 *samples;
+    int length;
+    int position;
+} voice;
+
+// Sound effects mixed by hand in the SDL audio callback. Effects are decoded into
+// mono PCM buffers up front and triggered through a lock-free queue, so playing
+// a sound never blocks or allocates on the game thread.
+class SoundMixer
+{
+private:
+    SDL_AudioDeviceID device = 0;
+    SDL_AudioSpec spec;
+
+    std::array<std::vector<Sint16>, SOUND_EFFECTS_TOTAL> sounds;
+
+    // Audio thread only
+    std::array<voice, MIXER_VOICES> voices = {};
+    // Voices still sounding after the last mixed buffer, written by the audio thread
+    std::atomic<int> playingVoices;
+
+    SpscQueue<soundCommand, MIXER_QUEUE_CAPACITY> commands;
+
+    // Event to audible latency, in microsecounds, written by the audio thread
+    std::atomic<Uint64> latencySum;
+    std::atomic<Uint64> latencyMax;
+    std::atomic<Uint64> latencyCount;
+
+    static void mix(void *mixer, Uint8 *stream, int length);
+    void startVoice(const soundCommand &command);
+
+    bool loadSound(soundEffects effect, std::string path);
+    void synthesizeSound(soundEffects effect);
+
+public:
+    SoundMixer();
+    ~SoundMixer();
+
+    bool open(int bufferSamples);
+    void close();
+
+    void play(soundEffects effect);
+
+    // Prints the average and worst delay from play() to the sound reaching the device
+    void reportLatency();
+};
+SoundMixer::SoundMixer() : playingVoices(0), latencySum(0), latencyMax(0), latencyCount(0)
+{
+}
+SoundMixer::~SoundMixer()
+{
+    close();
+}
+bool SoundMixer::open(int bufferSamples)
+{
+    SDL_AudioSpec desiredSpec = {};
+
+    desiredSpec.freq = MIXER_FREQUENCY;
+    desiredSpec.format = AUDIO_S16SYS;
+    desiredSpec.channels = 1;
+    desiredSpec.samples = bufferSamples;
+    desiredSpec.callback = mix;
+    desiredSpec.userdata = this;
+
+    // No changes allowed, SDL converts for the hardware so the mixer always sees this format
+    device = SDL_OpenAudioDevice(nullptr, 0, &desiredSpec, &spec, 0);
+
+    if (device == 0)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    const char *soundNames[SOUND_EFFECTS_TOTAL] = {"move", "rotate", "lock", "lineClear", "gameOver"};
+
+    for (int effect = 0; effect < SOUND_EFFECTS_TOTAL; effect++)
+    {
+        std::string path = std::string("./bin/sounds/") + soundNames[effect] + ".wav";
+
+        if (!loadSound(static_cast<soundEffects>(effect), path))
+        {
+            synthesizeSound(static_cast<soundEffects>(effect));
+        }
+    }
+
+    SDL_PauseAudioDevice(device, 0);
+    return true;
+}
+void SoundMixer::close()
+{
+    if (device == 0)
+    {
+        return;
+    }
+
+    // The game over sound starts as the game ends, let it and whatever else still plays finish
+    size_t longestSound = 0;
+    for (auto &sound : sounds)
+    {
+        longestSound = std::max(longestSound, sound.size());
+    }
+
+    Uint64 drainDeadline = SDL_GetTicks64() + (longestSound + spec.samples) * 1000 / spec.freq;
+
+    while ((!commands.empty() || playingVoices != 0) && SDL_GetTicks64() < drainDeadline)
+    {
+        SDL_Delay(MIXER_DRAIN_POLL);
+    }
+
+    SDL_CloseAudioDevice(device);
+    device = 0;
+}
+void SoundMixer::reportLatency()
+{
+    if (latencyCount == 0)
+    {
+        return;
+    }
+
+    std::cout << "Audio latency: " << latencySum / latencyCount / 1000.0 << " ms average, "
+              << latencyMax / 1000.0 << " ms max with " << spec.samples << " samples at " << spec.freq << " Hz" << std::endl;
+}
+void SoundMixer::play(soundEffects effect)
+{
+    if (device == 0)
+    {
+        return;
+    }
+
+    soundCommand command;
+
+    command.effect = effect;
+    command.time = SDL_GetPerformanceCounter();
+
+    // A full queue means the audio thread is stalled, the sound would be late anyway
+    commands.push(command);
+}
+void SoundMixer::startVoice(const soundCommand &command)
+{
+    const std::vector<Sint16> &sound = sounds[command.effect];
+
+    // Take a free voice or cut off the one closest to finishing
+    voice *target = &voices[0];
+    for (auto &mixerVoice : voices)
+    {
+        if (mixerVoice.samples == nullptr)
+        {
+            target = &mixerVoice;
+            break;
+        }
+        if (mixerVoice.length - mixerVoice.position < target->length - target->position)
+        {
+            target = &mixerVoice;
+        }
+    }
+
+    target->samples = sound.data();
+    target->length = sound.size();
+    target->position = 0;
+}
+void SoundMixer::mix(void *mixer, Uint8 *stream, int length)
+{
+    SoundMixer *self = static_cast<SoundMixer *>(mixer);
+
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    // This buffer is heard once the one playing now is done
+    Uint64 bufferLatency = self->spec.samples * 1000000ULL / self->spec.freq;
+
+    soundCommand command;
+    while (self->commands.pop(command))
+    {
+        self->startVoice(command);
+
+        Uint64 latency = (now - command.time) * 1000000 / frequency + bufferLatency;
+
+        self->latencySum += latency;
+        self->latencyCount++;
+        if (latency > self->latencyMax)
+        {
+            self->latencyMax = latency;
+        }
+    }
+
+    Sint16 *output = reinterpret_cast<Sint16 *>(stream);
+    int samples = length / sizeof(Sint16);
+
+    for (int i = 0; i < samples; i++)
+    {
+        int sample = 0;
+
+        for (auto &mixerVoice : self->voices)
+        {
+            if (mixerVoice.samples != nullptr)
+            {
+                sample += mixerVoice.samples[mixerVoice.position++];
+
+                if (mixerVoice.position == mixerVoice.length)
+                {
+                    mixerVoice.samples = nullptr;
+                }
+            }
+        }
+
+        output[i] = std::clamp(sample, -32768, 32767);
+    }
+
+    int stillPlaying = 0;
+    for (auto &mixerVoice : self->voices)
+    {
+        stillPlaying += mixerVoice.samples != nullptr;
+    }
+    self->playingVoices = stillPlaying;
+}
+// Loads a WAV file and converts it to the device format
+bool SoundMixer::loadSound(soundEffects effect, std::string path)
+{
+    SDL_AudioSpec wavSpec;
+    Uint8 *wavBuffer;
+    Uint32 wavLength;
+
+    if (SDL_LoadWAV(path.c_str(), &wavSpec, &wavBuffer, &wavLength) == nullptr)
+    {
+        return false;
+    }
+
+    SDL_AudioCVT converter;
+    SDL_BuildAudioCVT(&converter, wavSpec.format, wavSpec.channels, wavSpec.freq, spec.format, spec.channels, spec.freq);
+
+    std::vector<Uint8> converted(wavLength * converter.len_mult);
+    std::copy(wavBuffer, wavBuffer + wavLength, converted.begin());
+    SDL_FreeWAV(wavBuffer);
+
+    converter.buf = converted.data();
+    converter.len = wavLength;
+
+    if (converter.needed && SDL_ConvertAudio(&converter) < 0)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    const Sint16 *samples = reinterpret_cast<const Sint16 *>(converted.data());
+    sounds[effect].assign(samples, samples + converter.len_cvt / sizeof(Sint16));
+
+    return !sounds[effect].empty();
+}
+// Short square wave sweeps, used when no WAV file is shipped for the effect
+void SoundMixer::synthesizeSound(soundEffects effect)
+{
+    float startPitch, endPitch, duration;
+
+    switch (effect)
+    {
+    case SOUND_MOVE:
+        startPitch = 1200, endPitch = 1200, duration = 0.03F;
+        break;
+    case SOUND_ROTATE:
+        startPitch = 900, endPitch = 1100, duration = 0.04F;
+        break;
+    case SOUND_LOCK:
+        startPitch = 220, endPitch = 160, duration = 0.08F;
+        break;
+    case SOUND_LINE_CLEAR:
+        startPitch = 600, endPitch = 1500, duration = 0.2F;
+        break;
+    default:
+        startPitch = 400, endPitch = 100, duration = 0.6F;
+        break;
+    }
+
+    int length = duration * spec.freq;
+    std::vector<Sint16> &sound = sounds[effect];
+    sound.resize(length);
+
+    float phase = 0;
+    for (int i = 0; i < length; i++)
+    {
+        float progress = static_cast<float>(i) / length;
+        float pitch = startPitch + (endPitch - startPitch) * progress;
+
+        phase += pitch / spec.freq;
+        phase -= std::floor(phase);
+
+        // Linear fade out so voices do not click when they end
+        float amplitude = 6000 * (1 - progress);
+        sound[i] = phase < 0.5F ? amplitude : -amplitude;
+    }
+}
+#endif
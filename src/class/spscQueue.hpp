@@ -0,0 +1,63 @@
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+// Lock-free ring buffer for exactly one producer thread and one consumer thread.
+// CAPACITY has to be a power of two, push fails instead of blocking when full.
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity has to be a power of two");
+
+    std::array<T, CAPACITY> items;
+
+    // Kept on separate cache lines so producer and consumer do not fight over them
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+
+public:
+    bool push(const T &item);
+    bool pop(T &item);
+
+    bool empty();
+};
+template <typename T, size_t CAPACITY>
+bool SpscQueue<T, CAPACITY>::push(const T &item)
+{
+    size_t currentTail = tail.load(std::memory_order_relaxed);
+
+    if (currentTail - head.load(std::memory_order_acquire) == CAPACITY)
+    {
+        return false;
+    }
+
+    items[currentTail & (CAPACITY - 1)] = item;
+    tail.store(currentTail + 1, std::memory_order_release);
+
+    return true;
+}
+template <typename T, size_t CAPACITY>
+bool SpscQueue<T, CAPACITY>::pop(T &item)
+{
+    size_t currentHead = head.load(std::memory_order_relaxed);
+
+    if (currentHead == tail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    item = items[currentHead & (CAPACITY - 1)];
+    head.store(currentHead + 1, std::memory_order_release);
+
+    return true;
+}
+template <typename T, size_t CAPACITY>
+bool SpscQueue<T, CAPACITY>::empty()
+{
+    return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+}
+#endif
@@ -0,0 +1,214 @@
+#include <SDL2/SDL.h>
+
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+
+#include "./spscQueue.hpp"
+
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#define TELEMETRY_QUEUE_CAPACITY 4096
+
+// In milisecounds
+#define TELEMETRY_FLUSH_INTERVAL 100
+
+enum telemetryEventTypes
+{
+    TELEMETRY_START,
+    TELEMETRY_INPUT,
+    TELEMETRY_LOCK,
+    TELEMETRY_GAME_OVER
+};
+
+typedef struct telemetryEvent
+{
+    Uint64 time;
+    telemetryEventTypes type;
+    // Start events only, written in the key column
+    Uint64 seed;
+    // Input events only
+    const char *key;
+    // Lock events only
+    int rowsCleared;
+    int stackHeight;
+    Uint32 lockToSpawn;
+} telemetryEvent;
+
+// Gameplay metrics written as CSV by a background thread. The game thread only
+// pushes fixed size records into a ring buffer, events are dropped when it is full.
+class Telemetry
+{
+private:
+    FILE *file = nullptr;
+
+    SpscQueue<telemetryEvent, TELEMETRY_QUEUE_CAPACITY> events;
+    Uint64 droppedEvents = 0;
+
+    SDL_Thread *writer = nullptr;
+    std::atomic<bool> running;
+
+    static int work(void *telemetry);
+    void writeEvents();
+    void push(const telemetryEvent &event);
+
+public:
+    Telemetry();
+    ~Telemetry();
+
+    bool open(const char *path);
+    void close();
+
+    // The seed and the inputs are enough to replay a game, see frameBenchmark.cpp
+    void recordStart(Uint64 seed);
+    void recordInput(Uint64 time, const char *key);
+    void recordLock(Uint64 time, int rowsCleared, int stackHeight, Uint32 lockToSpawn);
+    void recordGameOver(Uint64 time);
+};
+Telemetry::Telemetry() : running(false)
+{
+}
+Telemetry::~Telemetry()
+{
+    close();
+}
+bool Telemetry::open(const char *path)
+{
+    file = fopen(path, "w");
+
+    if (file == nullptr)
+    {
+        std::cerr << "Cannot open telemetry file " << path << std::endl;
+        return false;
+    }
+
+    fprintf(file, "time_ms,event,key,rows_cleared,stack_height,lock_to_spawn_us\n");
+
+    running = true;
+    writer = SDL_CreateThread(work, "Telemetry", this);
+
+    // Without the writer nothing would drain the queue, so telemetry stays off
+    if (writer == nullptr)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+        running = false;
+
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+    return true;
+}
+void Telemetry::close()
+{
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    running = false;
+    if (writer != nullptr)
+    {
+        SDL_WaitThread(writer, nullptr);
+        writer = nullptr;
+    }
+
+    writeEvents();
+
+    if (droppedEvents != 0)
+    {
+        std::cerr << "Telemetry dropped " << droppedEvents << " events" << std::endl;
+    }
+
+    fclose(file);
+    file = nullptr;
+}
+int Telemetry::work(void *telemetry)
+{
+    Telemetry *self = static_cast<Telemetry *>(telemetry);
+
+    while (self->running)
+    {
+        SDL_Delay(TELEMETRY_FLUSH_INTERVAL);
+        self->writeEvents();
+    }
+    return 0;
+}
+void Telemetry::writeEvents()
+{
+    telemetryEvent event;
+    while (events.pop(event))
+    {
+        switch (event.type)
+        {
+        case TELEMETRY_START:
+            fprintf(file, "%llu,start,%llu,,,\n", (unsigned long long)event.time, (unsigned long long)event.seed);
+            break;
+        case TELEMETRY_INPUT:
+            fprintf(file, "%llu,input,%s,,,\n", (unsigned long long)event.time, event.key);
+            break;
+        case TELEMETRY_LOCK:
+            fprintf(file, "%llu,lock,,%d,%d,%u\n", (unsigned long long)event.time, event.rowsCleared, event.stackHeight, event.lockToSpawn);
+            break;
+        case TELEMETRY_GAME_OVER:
+            fprintf(file, "%llu,game_over,,,,\n", (unsigned long long)event.time);
+            break;
+        }
+    }
+    fflush(file);
+}
+void Telemetry::push(const telemetryEvent &event)
+{
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    if (!events.push(event))
+    {
+        droppedEvents++;
+    }
+}
+void Telemetry::recordStart(Uint64 seed)
+{
+    telemetryEvent event = {};
+
+    event.time = 0;
+    event.type = TELEMETRY_START;
+    event.seed = seed;
+
+    push(event);
+}
+void Telemetry::recordInput(Uint64 time, const char *key)
+{
+    telemetryEvent event = {};
+
+    event.time = time;
+    event.type = TELEMETRY_INPUT;
+    event.key = key;
+
+    push(event);
+}
+void Telemetry::recordLock(Uint64 time, int rowsCleared, int stackHeight, Uint32 lockToSpawn)
+{
+    telemetryEvent event = {};
+
+    event.time = time;
+    event.type = TELEMETRY_LOCK;
+    event.rowsCleared = rowsCleared;
+    event.stackHeight = stackHeight;
+    event.lockToSpawn = lockToSpawn;
+
+    push(event);
+}
+void Telemetry::recordGameOver(Uint64 time)
+{
+    telemetryEvent event = {};
+
+    event.time = time;
+    event.type = TELEMETRY_GAME_OVER;
+
+    push(event);
+}
+#endif
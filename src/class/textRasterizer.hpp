@@ -0,0 +1,277 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "./texture.hpp"
+#include "./spscQueue.hpp"
+
+#ifndef TEXT_RASTERIZER_HPP
+#define TEXT_RASTERIZER_HPP
+
+// Longest text shown on the HUD, including the terminating null
+#define HUD_TEXT_LENGTH 16
+
+// Textures that can be fed by the rasterizer at once
+#define TEXT_TARGETS_CAPACITY 4
+#define TEXT_QUEUE_CAPACITY 8
+
+typedef struct textRequest
+{
+    GTexture *target;
+    SDL_Color color;
+    int fontSize;
+    char text[HUD_TEXT_LENGTH];
+} textRequest;
+
+typedef struct textResult
+{
+    GTexture *target;
+    SDL_Surface *surface;
+    // Left edge of every character in the surface, followed by the width of the whole text
+    std::array<int, HUD_TEXT_LENGTH> glyphsX;
+} textResult;
+
+// Rasterizes text surfaces on a worker thread. The main thread only uploads
+// finished surfaces, so a texture keeps its previous text until its new one is ready.
+class TextRasterizer
+{
+private:
+    typedef struct textTarget
+    {
+        GTexture *texture;
+        textRequest latest;
+        bool inFlight;
+        bool pending;
+        std::array<int, HUD_TEXT_LENGTH> glyphsX;
+    } textTarget;
+
+    TTF_Font *gFont;
+    // Size of the next requests, only the worker touches the font itself
+    int fontSize = 0;
+
+    SpscQueue<textRequest, TEXT_QUEUE_CAPACITY> requests;
+    SpscQueue<textResult, TEXT_QUEUE_CAPACITY> results;
+
+    SDL_sem *requestsSemaphore = nullptr;
+    SDL_Thread *worker = nullptr;
+    std::atomic<bool> running;
+
+    // Pushed when surfaces are ready, wakes a main loop sleeping in SDL_WaitEventTimeout
+    Uint32 textReadyEvent;
+
+    // Main thread only: at most one request per texture is queued, newer text waits in %latest%
+    std::array<textTarget, TEXT_TARGETS_CAPACITY> targets;
+    int targetsCount = 0;
+
+    static int work(void *rasterizer);
+
+    textTarget *getTarget(GTexture *texture);
+    void submit(textTarget *target);
+
+public:
+    TextRasterizer(TTF_Font *loadFont);
+    ~TextRasterizer();
+
+    // Later requests are rasterized at %ptsize%, textures keep their old size until requested again
+    void setFontSize(int ptsize);
+    void request(GTexture *target, const char *text, SDL_Color color);
+
+    // Uploads every finished surface, returns true when a texture changed
+    bool uploadReady();
+    // No text is waiting for the worker or for its upload
+    bool isIdle();
+
+    // Where the characters of the text uploaded into %texture% start, so single ones can be cut out of it
+    const int *getGlyphsX(GTexture *texture);
+};
+TextRasterizer::TextRasterizer(TTF_Font *loadFont) : gFont(loadFont), running(true)
+{
+    textReadyEvent = SDL_RegisterEvents(1);
+
+    requestsSemaphore = SDL_CreateSemaphore(0);
+    worker = SDL_CreateThread(work, "TextRasterizer", this);
+
+    if (requestsSemaphore == nullptr || worker == nullptr)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+    }
+}
+TextRasterizer::~TextRasterizer()
+{
+    running = false;
+    SDL_SemPost(requestsSemaphore);
+    SDL_WaitThread(worker, nullptr);
+
+    textResult result;
+    while (results.pop(result))
+    {
+        SDL_FreeSurface(result.surface);
+    }
+
+    SDL_DestroySemaphore(requestsSemaphore);
+}
+int TextRasterizer::work(void *rasterizer)
+{
+    TextRasterizer *self = static_cast<TextRasterizer *>(rasterizer);
+
+    int workerFontSize = 0;
+
+    while (self->running)
+    {
+        SDL_SemWait(self->requestsSemaphore);
+
+        textRequest request;
+        while (self->running && self->requests.pop(request))
+        {
+            if (request.fontSize != workerFontSize && request.fontSize != 0)
+            {
+                workerFontSize = request.fontSize;
+
+                if (TTF_SetFontSize(self->gFont, workerFontSize) < 0)
+                {
+                    std::cerr << TTF_GetError() << std::endl;
+                }
+            }
+
+            textResult result;
+
+            result.target = request.target;
+            result.surface = TTF_RenderText_Solid(self->gFont, request.text, request.color);
+
+            if (result.surface == nullptr)
+            {
+                std::cerr << TTF_GetError() << std::endl;
+            }
+
+            // Measuring every prefix keeps the kerning the rendered text was laid out with
+            int textLength = strlen(request.text);
+            for (int i = 0; i <= textLength; i++)
+            {
+                char prefix[HUD_TEXT_LENGTH];
+                snprintf(prefix, HUD_TEXT_LENGTH, "%.*s", i, request.text);
+
+                if (TTF_SizeText(self->gFont, prefix, &result.glyphsX[i], nullptr) < 0)
+                {
+                    result.glyphsX[i] = 0;
+                }
+            }
+
+            // Cannot overflow, every texture has at most one request in flight
+            self->results.push(result);
+
+            SDL_Event textReady = {};
+            textReady.type = self->textReadyEvent;
+            SDL_PushEvent(&textReady);
+        }
+    }
+    return 0;
+}
+TextRasterizer::textTarget *TextRasterizer::getTarget(GTexture *texture)
+{
+    for (int i = 0; i < targetsCount; i++)
+    {
+        if (targets[i].texture == texture)
+        {
+            return &targets[i];
+        }
+    }
+
+    if (targetsCount == TEXT_TARGETS_CAPACITY)
+    {
+        return nullptr;
+    }
+
+    textTarget &target = targets[targetsCount++];
+
+    target.texture = texture;
+    target.inFlight = false;
+    target.pending = false;
+    target.glyphsX.fill(0);
+
+    return &target;
+}
+void TextRasterizer::submit(textTarget *target)
+{
+    requests.push(target->latest);
+
+    target->inFlight = true;
+    target->pending = false;
+
+    SDL_SemPost(requestsSemaphore);
+}
+void TextRasterizer::setFontSize(int ptsize)
+{
+    fontSize = ptsize;
+}
+void TextRasterizer::request(GTexture *texture, const char *text, SDL_Color color)
+{
+    textTarget *target = getTarget(texture);
+
+    if (target == nullptr)
+    {
+        std::cerr << "Too many textures for the text rasterizer" << std::endl;
+        return;
+    }
+
+    target->latest.target = texture;
+    target->latest.color = color;
+    target->latest.fontSize = fontSize;
+    snprintf(target->latest.text, HUD_TEXT_LENGTH, "%s", text);
+
+    if (target->inFlight)
+    {
+        target->pending = true;
+        return;
+    }
+    submit(target);
+}
+bool TextRasterizer::uploadReady()
+{
+    bool uploaded = false;
+
+    textResult result;
+    while (results.pop(result))
+    {
+        textTarget *target = getTarget(result.target);
+
+        if (result.surface != nullptr)
+        {
+            result.target->loadSurfaceTexture(result.surface);
+            SDL_FreeSurface(result.surface);
+
+            target->glyphsX = result.glyphsX;
+            uploaded = true;
+        }
+
+        target->inFlight = false;
+
+        if (target->pending)
+        {
+            submit(target);
+        }
+    }
+    return uploaded;
+}
+bool TextRasterizer::isIdle()
+{
+    for (int i = 0; i < targetsCount; i++)
+    {
+        if (targets[i].inFlight || targets[i].pending)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+const int *TextRasterizer::getGlyphsX(GTexture *texture)
+{
+    textTarget *target = getTarget(texture);
+
+    return target != nullptr ? target->glyphsX.data() : nullptr;
+}
+#endif
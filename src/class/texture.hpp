@@ -23,8 +23,13 @@ public:
         free();
     }
 
-    void loadTextTexture(std::string text, SDL_Color textColor, TTF_Font *textFont);
+    void loadTextTexture(const char *text, SDL_Color textColor, TTF_Font *textFont);
     void loadImgTexture(std::string path);
+    void loadSurfaceTexture(SDL_Surface *surface);
+    // Empty texture the renderer can draw into with SDL_SetRenderTarget
+    bool loadTargetTexture(int targetWidth, int targetHeight);
+
+    SDL_Texture *getTexture();
 
     int getHeight();
     int getWidth();
@@ -73,30 +78,52 @@ void GTexture::loadImgTexture(std::string path)
 
     SDL_FreeSurface(loadSuface);
 }
-void GTexture::loadTextTexture(std::string text, SDL_Color textColor, TTF_Font *textFont)
+void GTexture::loadTextTexture(const char *text, SDL_Color textColor, TTF_Font *textFont)
 {
     free();
 
-    SDL_Surface *textSuface = TTF_RenderText_Solid(textFont, text.c_str(), textColor);
+    SDL_Surface *textSuface = TTF_RenderText_Solid(textFont, text, textColor);
     if (textSuface == nullptr)
     {
         std::cerr << TTF_GetError() << std::endl;
         return;
     }
 
-    mTexture = SDL_CreateTextureFromSurface(gRenderer, textSuface);
+    loadSurfaceTexture(textSuface);
+
+    SDL_FreeSurface(textSuface);
+}
+// Replaces the texture with the surface contents, the surface stays owned by the caller
+void GTexture::loadSurfaceTexture(SDL_Surface *surface)
+{
+    free();
+
+    mTexture = SDL_CreateTextureFromSurface(gRenderer, surface);
 
     if (mTexture == nullptr)
     {
         std::cerr << SDL_GetError() << std::endl;
-        SDL_FreeSurface(textSuface);
         return;
     }
 
-    this->height = textSuface->h;
-    this->width = textSuface->w;
+    this->height = surface->h;
+    this->width = surface->w;
+}
+bool GTexture::loadTargetTexture(int targetWidth, int targetHeight)
+{
+    free();
 
-    SDL_FreeSurface(textSuface);
+    mTexture = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, targetWidth, targetHeight);
+
+    if (mTexture == nullptr)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    this->height = targetHeight;
+    this->width = targetWidth;
+    return true;
 }
 GTexture::~GTexture()
 {
@@ -120,4 +147,8 @@ int GTexture::getWidth()
 {
     return width;
 }
+SDL_Texture *GTexture::getTexture()
+{
+    return mTexture;
+}
 #endif
\ No newline at end of file
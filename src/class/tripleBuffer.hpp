@@ -0,0 +1,64 @@
+#include <array>
+#include <atomic>
+
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+// Lock-free hand-off of the latest value from one writer thread to one reader thread.
+// The writer fills back() and publishes it, the reader picks up the newest published
+// value with acquire(). Neither side ever waits, stale values are simply skipped.
+template <typename T>
+class TripleBuffer
+{
+private:
+    static const int FRESH = 4;
+
+    std::array<T, 3> buffers = {};
+
+    // Index of the buffer between writer and reader, FRESH when the reader has not taken it yet
+    std::atomic<int> middle{1};
+
+    int writeIndex = 0;
+    int readIndex = 2;
+
+public:
+    T &back();
+    void publish();
+
+    bool hasFresh();
+    bool acquire();
+    const T &front();
+};
+template <typename T>
+T &TripleBuffer<T>::back()
+{
+    return buffers[writeIndex];
+}
+template <typename T>
+void TripleBuffer<T>::publish()
+{
+    writeIndex = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel) & ~FRESH;
+}
+template <typename T>
+bool TripleBuffer<T>::hasFresh()
+{
+    return (middle.load(std::memory_order_acquire) & FRESH) != 0;
+}
+// Swaps the newest published value to the front, returns false when nothing new was published
+template <typename T>
+bool TripleBuffer<T>::acquire()
+{
+    if (!hasFresh())
+    {
+        return false;
+    }
+
+    readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & ~FRESH;
+    return true;
+}
+template <typename T>
+const T &TripleBuffer<T>::front()
+{
+    return buffers[readIndex];
+}
+#endif
@@ -0,0 +1,470 @@
+// End to end frame time benchmark. Replays sessions recorded with `main --telemetry <path>`
+// through the whole frame (events, game update, text upload and render) with the software
+// renderer and no visible window, then compares the frame times with a baseline file.
+// bin/sessions/baseline.txt only holds the allocations, which do not depend on the machine, and
+// is checked with --allocations-only; write a baseline with the frame times on the machine that
+// runs the comparison, a baseline without them fails unless --allocations-only is given.
+// Build: g++ -std=c++17 -O2 src/frameBenchmark.cpp -o frameBenchmark -lSDL2 -lSDL2_ttf -lSDL2_image
+// Usage: frameBenchmark [--baseline <file>] [--allocations-only] [--write-baseline <file>] [--threshold <percent>] <session.csv>...
+// Example: ./frameBenchmark --allocations-only --baseline bin/sessions/baseline.txt bin/sessions/*.csv
+
+#ifndef ALLOC_COUNT
+#define ALLOC_COUNT
+#endif
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <SDL2/SDL_image.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "./class/allocCounter.hpp"
+#include "./class/tripleBuffer.hpp"
+#include "./class/renderSnapshot.hpp"
+#include "./class/gameRenderer.hpp"
+#include "./class/game.hpp"
+
+// In milisecounds, game time between two replayed frames
+#define BENCHMARK_FRAME_TIME 16
+
+// In milisecounds, how long a replay waits for its HUD text
+#define BENCHMARK_HUD_WAIT 1000
+
+// In percent, how much slower than the baseline a percentile may get
+#define BENCHMARK_THRESHOLD 10
+// In microseconds, smaller differences are measurement noise
+#define BENCHMARK_NOISE_FLOOR 20
+
+enum benchmarkPhases
+{
+    PHASE_EVENTS,
+    PHASE_UPDATE,
+    PHASE_RENDER,
+    PHASE_FRAME,
+    PHASES_TOTAL
+};
+
+const char *phaseNames[PHASES_TOTAL] = {"events", "update", "render", "frame"};
+
+typedef struct sessionInput
+{
+    Uint64 time;
+    arrows key;
+    bool hardDrop;
+} sessionInput;
+
+typedef struct session
+{
+    unsigned seed = 0;
+    std::vector<sessionInput> inputs;
+    Uint64 duration = 0;
+} session;
+
+// p50, p95 and p99 of every phase in microseconds, plus the allocations made after warm up
+typedef struct benchmarkResult
+{
+    std::array<std::array<double, 3>, PHASES_TOTAL> percentiles = {};
+    // Phases a baseline file has times for
+    std::array<bool, PHASES_TOTAL> timedPhases = {};
+    Uint64 allocations = 0;
+} benchmarkResult;
+
+const std::array<double, 3> percentileRanks = {50, 95, 99};
+
+bool loadSession(const char *path, session &loaded)
+{
+    std::ifstream sessionFile(path);
+
+    if (!sessionFile)
+    {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    std::getline(sessionFile, line);
+
+    while (std::getline(sessionFile, line))
+    {
+        std::array<std::string, 6> fields;
+        std::stringstream lineStream(line);
+
+        for (auto &field : fields)
+        {
+            std::getline(lineStream, field, ',');
+        }
+
+        if (fields[0].empty())
+        {
+            continue;
+        }
+
+        Uint64 time = std::stoull(fields[0]);
+        loaded.duration = std::max(loaded.duration, time);
+
+        if (fields[1] == "start")
+        {
+            loaded.seed = std::stoul(fields[2]);
+        }
+        else if (fields[1] == "input")
+        {
+            sessionInput input = {time, ARROW_NONE, false};
+
+            if (fields[2] == "up")
+            {
+                input.key = ARROW_UP;
+            }
+            else if (fields[2] == "right")
+            {
+                input.key = ARROW_RIGHT;
+            }
+            else if (fields[2] == "down")
+            {
+                input.key = ARROW_DOWN;
+            }
+            else if (fields[2] == "left")
+            {
+                input.key = ARROW_LEFT;
+            }
+            else if (fields[2] == "hard_drop")
+            {
+                input.hardDrop = true;
+            }
+
+            loaded.inputs.push_back(input);
+        }
+    }
+    return true;
+}
+
+double toMicroseconds(Uint64 counterTicks)
+{
+    return counterTicks * 1000000.0 / SDL_GetPerformanceFrequency();
+}
+
+// Replays one session frame by frame, appending the time of every phase to %samples%
+void replaySession(const session &replayed, SDL_Renderer *gRenderer, TTF_Font *gFont,
+                   std::array<std::vector<double>, PHASES_TOTAL> &samples, Uint64 &allocations)
+{
+    TripleBuffer<renderSnapshot> snapshots;
+
+    Game tGame(&snapshots, nullptr, nullptr, replayed.seed);
+    GameRenderer gameRenderer(gRenderer, gFont, snapshots);
+
+    // Reserved up front, growing the sample buffers would count as frame allocations
+    size_t framesCount = replayed.duration / BENCHMARK_FRAME_TIME + 2;
+    for (auto &phaseSamples : samples)
+    {
+        phaseSamples.reserve(phaseSamples.size() + framesCount);
+    }
+
+    // The glyph strip is uploaded whenever the worker finishes it, which would land an
+    // allocation in a random frame, so the replay starts once it is on screen
+    for (int wait = 0; wait < BENCHMARK_HUD_WAIT; wait++)
+    {
+        gameRenderer.render();
+        if (gameRenderer.isHudReady())
+        {
+            break;
+        }
+        SDL_Delay(1);
+    }
+
+    size_t nextInput = 0;
+    Uint64 gameTime = 0;
+
+    for (size_t frame = 0; frame < framesCount && !tGame.exit; frame++)
+    {
+        gameTime += BENCHMARK_FRAME_TIME;
+
+        // One input per frame like a player, later inputs wait for the next frame
+        sessionInput input = {gameTime, ARROW_NONE, false};
+        if (nextInput < replayed.inputs.size() && replayed.inputs[nextInput].time <= gameTime)
+        {
+            input = replayed.inputs[nextInput++];
+        }
+
+        Uint64 allocationsBefore = allocationsCount;
+        Uint64 frameStart = SDL_GetPerformanceCounter();
+
+        tGame.handleEvents();
+        Uint64 eventsEnd = SDL_GetPerformanceCounter();
+
+        tGame.step(input.key, BENCHMARK_FRAME_TIME, input.hardDrop);
+        Uint64 updateEnd = SDL_GetPerformanceCounter();
+
+        gameRenderer.render();
+        Uint64 renderEnd = SDL_GetPerformanceCounter();
+
+        if (frame < ALLOC_WARMUP_FRAMES)
+        {
+            continue;
+        }
+
+        allocations += allocationsCount - allocationsBefore;
+
+        samples[PHASE_EVENTS].push_back(toMicroseconds(eventsEnd - frameStart));
+        samples[PHASE_UPDATE].push_back(toMicroseconds(updateEnd - eventsEnd));
+        samples[PHASE_RENDER].push_back(toMicroseconds(renderEnd - updateEnd));
+        samples[PHASE_FRAME].push_back(toMicroseconds(renderEnd - frameStart));
+    }
+}
+// Nearest rank percentile
+double getPercentile(std::vector<double> &phaseSamples, double rank)
+{
+    if (phaseSamples.empty())
+    {
+        return 0;
+    }
+
+    size_t index = std::ceil(rank / 100 * phaseSamples.size());
+    index = std::min(std::max(index, static_cast<size_t>(1)), phaseSamples.size()) - 1;
+
+    std::nth_element(phaseSamples.begin(), phaseSamples.begin() + index, phaseSamples.end());
+    return phaseSamples[index];
+}
+bool readBaseline(const char *path, benchmarkResult &baseline)
+{
+    std::ifstream baselineFile(path);
+
+    if (!baselineFile)
+    {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+
+    std::string name;
+    while (baselineFile >> name)
+    {
+        if (name == "allocations")
+        {
+            baselineFile >> baseline.allocations;
+            continue;
+        }
+
+        for (int phase = 0; phase < PHASES_TOTAL; phase++)
+        {
+            if (name == phaseNames[phase])
+            {
+                baseline.timedPhases[phase] = true;
+                for (auto &percentile : baseline.percentiles[phase])
+                {
+                    baselineFile >> percentile;
+                }
+            }
+        }
+    }
+    return true;
+}
+bool writeBaseline(const char *path, const benchmarkResult &result)
+{
+    FILE *baselineFile = fopen(path, "w");
+
+    if (baselineFile == nullptr)
+    {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+
+    for (int phase = 0; phase < PHASES_TOTAL; phase++)
+    {
+        const std::array<double, 3> &percentiles = result.percentiles[phase];
+        fprintf(baselineFile, "%s %.1f %.1f %.1f\n", phaseNames[phase], percentiles[0], percentiles[1], percentiles[2]);
+    }
+    fprintf(baselineFile, "allocations %llu\n", (unsigned long long)result.allocations);
+
+    fclose(baselineFile);
+    return true;
+}
+// Returns false when a percentile or the allocations regressed past the threshold,
+// or when the baseline has no times to compare with and %allocationsOnly% is not set
+bool compareBaseline(const benchmarkResult &result, const benchmarkResult &baseline, double threshold, bool allocationsOnly)
+{
+    bool passed = true;
+
+    for (int phase = 0; phase < PHASES_TOTAL && !allocationsOnly; phase++)
+    {
+        if (!baseline.timedPhases[phase])
+        {
+            printf("Baseline has no %s times, write one with --write-baseline or pass --allocations-only\n", phaseNames[phase]);
+            passed = false;
+            continue;
+        }
+
+        for (size_t i = 0; i < percentileRanks.size(); i++)
+        {
+            double current = result.percentiles[phase][i];
+            double allowed = std::max(baseline.percentiles[phase][i] * (1 + threshold / 100), baseline.percentiles[phase][i] + BENCHMARK_NOISE_FLOOR);
+
+            if (current > allowed)
+            {
+                printf("Regression: %s p%.0f %.1f us, baseline %.1f us\n", phaseNames[phase], percentileRanks[i], current, baseline.percentiles[phase][i]);
+                passed = false;
+            }
+        }
+    }
+
+    if (result.allocations > baseline.allocations)
+    {
+        printf("Regression: %llu allocations, baseline %llu\n", (unsigned long long)result.allocations, (unsigned long long)baseline.allocations);
+        passed = false;
+    }
+    return passed;
+}
+
+int main(int argc, char **argv)
+{
+    const char *baselinePath = nullptr;
+    const char *writeBaselinePath = nullptr;
+    bool allocationsOnly = false;
+    double threshold = BENCHMARK_THRESHOLD;
+    std::vector<const char *> sessionPaths;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+        {
+            baselinePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--allocations-only") == 0)
+        {
+            allocationsOnly = true;
+        }
+        else if (strcmp(argv[i], "--write-baseline") == 0 && i + 1 < argc)
+        {
+            writeBaselinePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+        {
+            threshold = atof(argv[++i]);
+        }
+        else
+        {
+            sessionPaths.push_back(argv[i]);
+        }
+    }
+
+    if (sessionPaths.empty())
+    {
+        std::cerr << "Usage: " << argv[0] << " [--baseline <file>] [--allocations-only] [--write-baseline <file>] [--threshold <percent>] <session.csv>..." << std::endl;
+        return 1;
+    }
+
+    std::vector<session> sessions(sessionPaths.size());
+    for (size_t i = 0; i < sessionPaths.size(); i++)
+    {
+        if (!loadSession(sessionPaths[i], sessions[i]))
+        {
+            return 1;
+        }
+    }
+
+    // No visible window unless the caller picked a driver, e.g. SDL_VIDEODRIVER=offscreen
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+
+    // Before SDL_Init, so surfaces and textures made by SDL and SDL_ttf are counted as well
+    countSdlAllocations();
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    if (TTF_Init() < 0)
+    {
+        std::cerr << TTF_GetError() << std::endl;
+        return 1;
+    }
+
+    if ((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0)
+    {
+        std::cerr << IMG_GetError() << std::endl;
+        return 1;
+    }
+
+    SDL_Window *gWindow = SDL_CreateWindow("Tetris benchmark", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 675, 750, SDL_WINDOW_HIDDEN);
+    SDL_Renderer *gRenderer = gWindow != nullptr ? SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_SOFTWARE) : nullptr;
+    TTF_Font *gFont = TTF_OpenFont("./bin/fonts/PixelifySans-Regular.ttf", 50);
+
+    if (gWindow == nullptr || gRenderer == nullptr)
+    {
+        std::cerr << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    if (gFont == nullptr)
+    {
+        std::cerr << TTF_GetError() << std::endl;
+        return 1;
+    }
+
+    std::array<std::vector<double>, PHASES_TOTAL> samples;
+    benchmarkResult result;
+
+    for (auto &replayed : sessions)
+    {
+        replaySession(replayed, gRenderer, gFont, samples, result.allocations);
+    }
+
+    printf("Frames:      %zu\n", samples[PHASE_FRAME].size());
+    printf("Phase        p50 us     p95 us     p99 us\n");
+
+    for (int phase = 0; phase < PHASES_TOTAL; phase++)
+    {
+        for (size_t i = 0; i < percentileRanks.size(); i++)
+        {
+            result.percentiles[phase][i] = getPercentile(samples[phase], percentileRanks[i]);
+        }
+        printf("%-8s %10.1f %10.1f %10.1f\n", phaseNames[phase], result.percentiles[phase][0], result.percentiles[phase][1], result.percentiles[phase][2]);
+    }
+    printf("Allocations: %llu\n", (unsigned long long)result.allocations);
+
+    int exitCode = 0;
+
+    if (baselinePath != nullptr)
+    {
+        benchmarkResult baseline;
+
+        if (!readBaseline(baselinePath, baseline))
+        {
+            exitCode = 1;
+        }
+        else if (!compareBaseline(result, baseline, threshold, allocationsOnly))
+        {
+            exitCode = 1;
+        }
+        else if (allocationsOnly)
+        {
+            printf("No more allocations than the baseline\n");
+        }
+        else
+        {
+            printf("Within %.0f%% of the baseline\n", threshold);
+        }
+    }
+
+    if (writeBaselinePath != nullptr && !writeBaseline(writeBaselinePath, result))
+    {
+        exitCode = 1;
+    }
+
+    TTF_CloseFont(gFont);
+    SDL_DestroyRenderer(gRenderer);
+    SDL_DestroyWindow(gWindow);
+
+    IMG_Quit();
+    TTF_Quit();
+    SDL_Quit();
+    return exitCode;
+}
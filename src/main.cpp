@@ -1,15 +1,29 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <SDL2/SDL_image.h>
 
 #include <iostream>
+#include <optional>
 #include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 
+#include "./class/allocCounter.hpp"
+#include "./class/cpuStats.hpp"
+#include "./class/telemetry.hpp"
+#include "./class/soundMixer.hpp"
+#include "./class/tripleBuffer.hpp"
+#include "./class/renderSnapshot.hpp"
+#include "./class/gameRenderer.hpp"
+#include "./class/simThread.hpp"
 #include "./class/game.hpp"
 
 bool init(SDL_Window **gWindow, SDL_Renderer **gRenderer);
 void load(TTF_Font **gFont);
 void close(SDL_Window *gWindow, SDL_Renderer *gRenderer,TTF_Font *gFont);
+int parseAudioBufferSamples(const char *text);
 
 int main(int argc, char **argv)
 {
@@ -18,26 +32,162 @@ int main(int argc, char **argv)
 
     TTF_Font *gFont = nullptr;
 
-    srand(time(NULL));
+    bool idleMode = false;
+    bool showCpuStats = false;
+    bool showAudioStats = false;
+    const char *telemetryPath = nullptr;
+    int audioBufferSamples = MIXER_BUFFER_SAMPLES;
+    bool simThreadMode = false;
+    bool interpolate = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--idle") == 0)
+        {
+            idleMode = true;
+        }
+        else if (strcmp(argv[i], "--cpu-stats") == 0)
+        {
+            showCpuStats = true;
+        }
+        else if (strcmp(argv[i], "--audio-stats") == 0)
+        {
+            showAudioStats = true;
+        }
+        else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc)
+        {
+            telemetryPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--audio-buffer") == 0 && i + 1 < argc)
+        {
+            audioBufferSamples = parseAudioBufferSamples(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sim-thread") == 0)
+        {
+            simThreadMode = true;
+        }
+        else if (strcmp(argv[i], "--interpolate") == 0)
+        {
+            interpolate = true;
+        }
+    }
+
+#ifdef ALLOC_COUNT
+    countSdlAllocations();
+#endif
 
     init(&gWindow, &gRenderer);
     load(&gFont);
 
-    Game tGame(gWindow, gRenderer, gFont);
+    int exitCode = 0;
 
-    while (!tGame.exit)
+    // Scoped so the game, the renderer and their workers are gone before SDL shuts down
     {
-        tGame.handleEvents();
-        tGame.update();
-        tGame.render();
+        TripleBuffer<renderSnapshot> snapshots;
+
+        Telemetry telemetry;
+        bool telemetryOpen = telemetryPath != nullptr && telemetry.open(telemetryPath);
+
+        SoundMixer mixer;
+        bool mixerOpen = mixer.open(audioBufferSamples);
+
+        Game tGame(&snapshots, telemetryOpen ? &telemetry : nullptr, mixerOpen ? &mixer : nullptr, time(NULL));
+        CpuStats cpuStats;
+
+        GameRenderer gameRenderer(gRenderer, gFont, snapshots);
+
+        if (interpolate)
+        {
+            gameRenderer.enableInterpolation();
+        }
+
+        if (idleMode)
+        {
+            tGame.enableIdleMode();
+        }
+
+        // Started last, from here on only the game thread touches tGame
+        std::optional<SimThread> simThread;
+
+        if (simThreadMode)
+        {
+            simThread.emplace(tGame, snapshots);
+
+            // The thread could not start, the game runs here instead
+            if (simThread->isFinished())
+            {
+                simThread.reset();
+            }
+        }
+
+#ifdef ALLOC_COUNT
+        AllocFrameCounter allocFrameCounter;
+#endif
+
+        while (simThread ? !simThread->isFinished() : !tGame.exit)
+        {
+#ifdef ALLOC_COUNT
+            allocFrameCounter.beginFrame();
+#endif
+            if (simThread)
+            {
+                // The game keeps its own time, this thread only sleeps until there is something to draw
+                simThread->pumpEvents(SIM_PUMP_TIMEOUT);
+            }
+            else
+            {
+                if (idleMode)
+                {
+                    tGame.waitEvents();
+                }
+                else
+                {
+                    tGame.handleEvents();
+                }
+
+                tGame.update();
+            }
+
+            bool redraw = gameRenderer.render();
+
+            if (showCpuStats)
+            {
+                cpuStats.frame(redraw);
+            }
+
+#ifdef ALLOC_COUNT
+            if (!allocFrameCounter.endFrame())
+            {
+                exitCode = 1;
+                break;
+            }
+#endif
+        }
+
+        if (showCpuStats)
+        {
+            cpuStats.report();
+        }
+
+        if (showAudioStats)
+        {
+            // Closed first so the latency of the last sounds is counted too
+            mixer.close();
+            mixer.reportLatency();
+        }
     }
 
     close(gWindow, gRenderer,gFont);
-    return 0;
+    return exitCode;
 }
 
 bool init(SDL_Window **gWindow, SDL_Renderer **gRenderer)
 {
+    // Read when the video subsystem starts. Without them Windows stretches the window bitmap
+    // and the renderer output never gets more pixels than the window has points.
+    SDL_SetHint(SDL_HINT_WINDOWS_DPI_AWARENESS, "permonitorv2");
+    SDL_SetHint(SDL_HINT_WINDOWS_DPI_SCALING, "1");
+
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
     {
         std::cerr << SDL_GetError() << std::endl;
@@ -50,7 +200,13 @@ bool init(SDL_Window **gWindow, SDL_Renderer **gRenderer)
         return false;
     }
 
-    *gWindow = SDL_CreateWindow("Tetris", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 675, 750, SDL_WINDOW_SHOWN);
+    if ((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0)
+    {
+        std::cerr << IMG_GetError() << std::endl;
+        return false;
+    }
+
+    *gWindow = SDL_CreateWindow("Tetris", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 675, 750, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI);
 
     if (*gWindow == nullptr)
     {
@@ -76,6 +232,30 @@ void load(TTF_Font **gFont)
         std::cerr << TTF_GetError() << std::endl;
     }
 }
+// A power of two from 1 to MIXER_BUFFER_SAMPLES, anything that is not a positive number gives the default
+int parseAudioBufferSamples(const char *text)
+{
+    char *textEnd;
+    long samples = strtol(text, &textEnd, 10);
+
+    if (textEnd == text || *textEnd != '\0' || samples < 1)
+    {
+        std::cerr << "Invalid audio buffer size " << text << ", using " << MIXER_BUFFER_SAMPLES << " samples" << std::endl;
+        return MIXER_BUFFER_SAMPLES;
+    }
+
+    int bufferSamples = 1;
+    while (bufferSamples * 2 <= std::min(samples, static_cast<long>(MIXER_BUFFER_SAMPLES)))
+    {
+        bufferSamples *= 2;
+    }
+
+    if (bufferSamples != samples)
+    {
+        std::cerr << "Audio buffer size " << text << " rounded to " << bufferSamples << " samples" << std::endl;
+    }
+    return bufferSamples;
+}
 void close(SDL_Window *gWindow, SDL_Renderer *gRenderer, TTF_Font *gFont)
 {
     SDL_DestroyWindow(gWindow);
@@ -85,6 +265,7 @@ void close(SDL_Window *gWindow, SDL_Renderer *gRenderer, TTF_Font *gFont)
     gRenderer = nullptr;
     gFont = nullptr;
 
+    IMG_Quit();
     TTF_Quit();
     SDL_Quit();
 }
\ No newline at end of file
@@ -0,0 +1,105 @@
+// Offline summary of a telemetry file written with `main --telemetry <path>`
+// Build: g++ -std=c++17 src/telemetrySummary.cpp -o telemetrySummary
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <telemetry.csv>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream telemetryFile(argv[1]);
+
+    if (!telemetryFile)
+    {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    unsigned long long duration = 0;
+    int pieces = 0;
+    int inputs = 0;
+    bool gameOver = false;
+
+    // Indexed by rows cleared at once, same categories as Game::calcPoints
+    std::array<int, 5> clears = {};
+
+    int maxStackHeight = 0;
+    long long stackHeightSum = 0;
+
+    unsigned long maxLockToSpawn = 0;
+    unsigned long long lockToSpawnSum = 0;
+
+    std::string line;
+    std::getline(telemetryFile, line);
+
+    while (std::getline(telemetryFile, line))
+    {
+        std::array<std::string, 6> fields;
+        std::stringstream lineStream(line);
+
+        for (auto &field : fields)
+        {
+            std::getline(lineStream, field, ',');
+        }
+
+        if (fields[0].empty())
+        {
+            continue;
+        }
+
+        duration = std::max(duration, std::stoull(fields[0]));
+
+        if (fields[1] == "input")
+        {
+            inputs++;
+        }
+        else if (fields[1] == "lock")
+        {
+            int rowsCleared = std::stoi(fields[3]);
+            int stackHeight = std::stoi(fields[4]);
+            unsigned long lockToSpawn = std::stoul(fields[5]);
+
+            pieces++;
+            clears[std::min(rowsCleared, 4)]++;
+
+            maxStackHeight = std::max(maxStackHeight, stackHeight);
+            stackHeightSum += stackHeight;
+
+            maxLockToSpawn = std::max(maxLockToSpawn, lockToSpawn);
+            lockToSpawnSum += lockToSpawn;
+        }
+        else if (fields[1] == "game_over")
+        {
+            gameOver = true;
+        }
+    }
+
+    double seconds = duration / 1000.0;
+
+    printf("Duration:            %.1f s%s\n", seconds, gameOver ? " (game over)" : "");
+    printf("Pieces:              %d\n", pieces);
+    printf("Pieces per second:   %.2f\n", seconds > 0 ? pieces / seconds : 0.0);
+    printf("Inputs per minute:   %.1f\n", seconds > 0 ? inputs * 60 / seconds : 0.0);
+    printf("Singles:             %d\n", clears[1]);
+    printf("Doubles:             %d\n", clears[2]);
+    printf("Triples:             %d\n", clears[3]);
+    printf("Tetrises:            %d\n", clears[4]);
+    printf("Lines:               %d\n", clears[1] + clears[2] * 2 + clears[3] * 3 + clears[4] * 4);
+
+    if (pieces > 0)
+    {
+        printf("Stack height:        %.1f average, %d max\n", (double)stackHeightSum / pieces, maxStackHeight);
+        printf("Lock to spawn:       %.1f us average, %lu us max\n", (double)lockToSpawnSum / pieces, maxLockToSpawn);
+    }
+    return 0;
+}